@@ -0,0 +1,96 @@
+#!/usr/bin/python3
+
+"""EXE members of zip and tar archives, read as streams without extracting.
+
+Only the start of each member is decompressed: the MZ header and the
+relocation table it points at are all the index needs for the header,
+relocation and footprint columns.
+"""
+
+import hashlib
+import tarfile
+import time
+import zipfile
+from collections import namedtuple
+
+from mzexe import HEADER_SIZE, MZExe, NotMZ
+
+
+ZIP_SUFFIXES = ('.zip',)
+TAR_SUFFIXES = ('.tar', '.tar.gz', '.tgz', '.tar.bz2', '.tbz2', '.tar.xz', '.txz')
+
+# Stand-in for os.stat_result, as index.record() only uses these two
+Stat = namedtuple('Stat', 'st_size st_mtime')
+
+Member = namedtuple('Member', 'path data stat sha')
+
+
+def is_archive(path):
+    name = path.name.lower()
+    return name.endswith(ZIP_SUFFIXES) or name.endswith(TAR_SUFFIXES)
+
+
+def read_prefix(f):
+    """Header and relocation table of an open member stream."""
+    data = f.read(HEADER_SIZE)
+    try:
+        exe = MZExe(data)
+    except NotMZ:
+        return data
+    need = max(exe.reloc_ofs + 4 * exe.nrelocs, HEADER_SIZE)
+    while len(data) < need:
+        more = f.read(need - len(data))
+        if not more:
+            break
+        data += more
+    return data
+
+
+def zip_members(path, known, full):
+    """Zip members are random access: only the prefix is inflated, and the
+    stored CRC-32 and size identify the content unless 'full' is set."""
+    with zipfile.ZipFile(path) as z:
+        for info in z.infolist():
+            if info.is_dir() or not info.filename.lower().endswith('.exe'):
+                continue
+            name = '%s!%s' % (path, info.filename)
+            st = Stat(info.file_size, time.mktime(info.date_time + (0, 0, -1)))
+            if known(name, st):
+                yield Member(name, None, st, None)
+                continue
+            with z.open(info) as f:
+                if full:
+                    yield Member(name, f.read(), st, None)
+                else:
+                    yield Member(name, read_prefix(f), st, 'crc32:%08x:%u' % (info.CRC, info.file_size))
+
+
+def tar_members(path, known, full):
+    """Compressed tars can only be read front to back, so the rest of each
+    member is hashed as it streams past rather than kept."""
+    with tarfile.open(path, 'r|*') as t:
+        for info in t:
+            if not info.isfile() or not info.name.lower().endswith('.exe'):
+                continue
+            name = '%s!%s' % (path, info.name)
+            st = Stat(info.size, float(info.mtime))
+            if known(name, st):
+                yield Member(name, None, st, None)
+                continue
+            f = t.extractfile(info)
+            if full:
+                yield Member(name, f.read(), st, None)
+                continue
+            data = read_prefix(f)
+            h = hashlib.sha256(data)
+            for block in iter(lambda: f.read(0x10000), b''):
+                h.update(block)
+            yield Member(name, data, st, h.hexdigest())
+
+
+def members(path, known=lambda name, st: False, full=False):
+    """Member per EXE in the archive; data is None when known(name, stat)
+    says the indexed copy is current, and sha is None when data is complete."""
+    if path.name.lower().endswith(ZIP_SUFFIXES):
+        return zip_members(path, known, full)
+    return tar_members(path, known, full)
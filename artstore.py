@@ -0,0 +1,135 @@
+#!/usr/bin/python3
+
+import argparse
+import hashlib
+import sqlite3
+import time
+import zlib
+from pathlib import Path
+from sys import exit
+
+import chunks
+
+
+SCHEMA = """
+CREATE TABLE IF NOT EXISTS files (
+    id INTEGER PRIMARY KEY,
+    version TEXT NOT NULL,
+    name TEXT NOT NULL,
+    size INTEGER NOT NULL,
+    sha256 TEXT NOT NULL,
+    added REAL NOT NULL,
+    UNIQUE (version, name)
+);
+CREATE TABLE IF NOT EXISTS file_chunks (
+    file INTEGER NOT NULL REFERENCES files (id) ON DELETE CASCADE,
+    seq INTEGER NOT NULL,
+    digest TEXT NOT NULL,
+    PRIMARY KEY (file, seq)
+);
+CREATE TABLE IF NOT EXISTS chunks (
+    digest TEXT PRIMARY KEY,
+    size INTEGER NOT NULL,
+    data BLOB NOT NULL
+);
+"""
+
+
+class Store:
+    """Build artifacts by version, stored as content-defined chunks.
+
+    Consecutive builds share most of their chunks, so each new version only
+    adds the blocks that changed. Every file keeps its own chunk list, so
+    any version is rebuilt directly, without replaying a chain of deltas.
+    """
+
+    def __init__(self, path):
+        self.con = sqlite3.connect(path)
+        self.con.execute("PRAGMA foreign_keys = ON")
+        self.con.executescript(SCHEMA)
+
+    def add(self, version, path, name=None):
+        data = Path(path).read_bytes()
+        name = name or Path(path).name
+        new = 0
+        self.con.execute("DELETE FROM files WHERE version = ? AND name = ?", (version, name))
+        cur = self.con.execute("INSERT INTO files (version, name, size, sha256, added) VALUES (?, ?, ?, ?, ?)",
+                               (version, name, len(data), hashlib.sha256(data).hexdigest(), time.time()))
+        fid = cur.lastrowid
+        for seq, (d, o, l) in enumerate(chunks.chunk(data)):
+            if not self.con.execute("SELECT 1 FROM chunks WHERE digest = ?", (d,)).fetchone():
+                self.con.execute("INSERT INTO chunks VALUES (?, ?, ?)",
+                                 (d, l, zlib.compress(data[o:o + l], 9)))
+                new += l
+            self.con.execute("INSERT INTO file_chunks VALUES (?, ?, ?)", (fid, seq, d))
+        self.con.commit()
+        return len(data), new
+
+    def get(self, version, name):
+        row = self.con.execute("SELECT id, sha256 FROM files WHERE version = ? AND name = ?",
+                               (version, name)).fetchone()
+        if row is None:
+            return None
+        parts = self.con.execute("SELECT c.data FROM file_chunks f JOIN chunks c ON c.digest = f.digest "
+                                 "WHERE f.file = ? ORDER BY f.seq", (row[0],))
+        data = b''.join(zlib.decompress(p[0]) for p in parts)
+        if hashlib.sha256(data).hexdigest() != row[1]:
+            raise ValueError("%s/%s: corrupt store" % (version, name))
+        return data
+
+    def versions(self):
+        return self.con.execute("SELECT version, name, size, added FROM files ORDER BY added, name").fetchall()
+
+    def stats(self):
+        files, raw = self.con.execute("SELECT COUNT(*), COALESCE(SUM(size), 0) FROM files").fetchone()
+        nchunks, unique, stored = self.con.execute(
+            "SELECT COUNT(*), COALESCE(SUM(size), 0), COALESCE(SUM(LENGTH(data)), 0) FROM chunks").fetchone()
+        return files, raw, nchunks, unique, stored
+
+    def prune(self):
+        """Drop chunks no file refers to any more."""
+        cur = self.con.execute("DELETE FROM chunks WHERE digest NOT IN (SELECT digest FROM file_chunks)")
+        self.con.commit()
+        self.con.execute("VACUUM")
+        return cur.rowcount
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Chunked, deduplicated store of build artifacts per version.")
+    parser.add_argument('store', help="store database")
+    sub = parser.add_subparsers(dest='cmd', required=True)
+    p = sub.add_parser('add', help="store files under a version (e.g. a commit id)")
+    p.add_argument('version')
+    p.add_argument('files', nargs='+')
+    p = sub.add_parser('get', help="rebuild a stored file")
+    p.add_argument('version')
+    p.add_argument('name')
+    p.add_argument('-o', '--output', help="output file (default: NAME)")
+    p = sub.add_parser('remove', help="forget a version")
+    p.add_argument('version')
+    sub.add_parser('list', help="list stored files")
+    sub.add_parser('stats', help="raw and stored sizes")
+    args = parser.parse_args()
+
+    st = Store(args.store)
+    if args.cmd == 'add':
+        for f in args.files:
+            size, new = st.add(args.version, f)
+            print("%s/%s: %u bytes, %u new" % (args.version, Path(f).name, size, new))
+    elif args.cmd == 'get':
+        data = st.get(args.version, args.name)
+        if data is None:
+            print("%s/%s: not stored" % (args.version, args.name))
+            exit(1)
+        Path(args.output or args.name).write_bytes(data)
+    elif args.cmd == 'remove':
+        st.con.execute("DELETE FROM files WHERE version = ?", (args.version,))
+        st.con.commit()
+        print("%u unreferenced chunks dropped" % st.prune())
+    elif args.cmd == 'list':
+        for version, name, size, added in st.versions():
+            print("%-20s %-16s %8u  %s" % (version, name, size, time.strftime('%Y-%m-%d %H:%M', time.localtime(added))))
+    else:
+        files, raw, nchunks, unique, stored = st.stats()
+        print("%u files, %u bytes; %u chunks, %u bytes distinct, %u bytes stored (%.1f%% of raw)"
+              % (files, raw, nchunks, unique, stored, 100.0 * stored / max(1, raw)))
@@ -0,0 +1,46 @@
+
+#include <stdio.h>
+
+#include "bench.h"
+#include "timer.h"
+
+#ifdef INTEGER_PRINTF
+#define printf iprintf
+#endif
+
+static unsigned long elapsed(const struct bench *b, unsigned iters, int arg) {
+	unsigned long t = timer_read();
+
+	b->run(iters, arg);
+	return timer_read() - t;
+}
+
+/* Tenths of a microsecond per iteration */
+static unsigned long per_iter(unsigned long counts, unsigned iters) {
+	return timer_us(counts * 10) / iters;
+}
+
+unsigned long bench_run(const struct bench *b, int arg, const char *tag) {
+	unsigned long t[BENCH_REPS], v;
+	unsigned iters = 1;
+	int i, j;
+
+	b->run(1, arg);
+	while (iters < BENCH_MAX_ITERS && elapsed(b, iters, arg) < BENCH_MIN_COUNTS)
+		iters *= 2;
+
+	/* Insertion sort as the repetitions come in */
+	for (i = 0; i < BENCH_REPS; i++) {
+		v = per_iter(elapsed(b, iters, arg), iters);
+		for (j = i; j > 0 && t[j - 1] > v; j--)
+			t[j] = t[j - 1];
+		t[j] = v;
+	}
+
+	printf("Bench: %s/%s iters=%u reps=%u min=%lu.%lu med=%lu.%lu max=%lu.%lu\n",
+	       b->name, tag, iters, BENCH_REPS,
+	       t[0] / 10, t[0] % 10,
+	       t[BENCH_REPS / 2] / 10, t[BENCH_REPS / 2] % 10,
+	       t[BENCH_REPS - 1] / 10, t[BENCH_REPS - 1] % 10);
+	return t[BENCH_REPS / 2];
+}
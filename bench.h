@@ -0,0 +1,32 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+/*
+ * Benchmark harness. BENCH(name) { ... } defines a benchmark whose body
+ * runs 'iters' times for the argument 'arg'; BENCH_ENTRY(name) lists it in
+ * a table. bench_run() warms the benchmark up, doubles the iteration count
+ * until a repetition takes BENCH_MIN_COUNTS, times BENCH_REPS repetitions
+ * and prints one line per benchmark, parsed by benchparse.py:
+ *
+ *	Bench: <name>/<tag> iters=<n> reps=<n> min=<us> med=<us> max=<us>
+ *
+ * Times are microseconds per iteration with one decimal; the median is
+ * also returned, in tenths of a microsecond. The timer must be in mode 2
+ * (timer_init()).
+ */
+#define BENCH_REPS		7
+#define BENCH_MIN_COUNTS	0x8000UL	/* 27 ms */
+#define BENCH_MAX_ITERS		0x8000u
+
+struct bench {
+	const char *name;
+	void (*run)(unsigned iters, int arg);
+};
+
+#define BENCH(name)		static void bench_##name(unsigned iters, int arg)
+#define BENCH_ENTRY(name)	{#name, bench_##name}
+#define BENCH_COUNT(table)	(sizeof (table) / sizeof (table)[0])
+
+unsigned long bench_run(const struct bench *b, int arg, const char *tag);
+
+#endif
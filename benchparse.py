@@ -0,0 +1,62 @@
+#!/usr/bin/python3
+
+import argparse
+import re
+from pathlib import Path
+from sys import exit
+
+
+LINE = re.compile(r'^Bench:\s+(\S+)((?:\s+\w+=\S+)*)\s*$')
+
+
+def parse(text):
+    """{benchmark: {key: value}} from bench_run() output; later runs win."""
+    out = {}
+    for line in text.splitlines():
+        m = LINE.match(line.strip())
+        if not m:
+            continue
+        fields = dict(kv.split('=', 1) for kv in m.group(2).split())
+        out[m.group(1)] = dict((k, float(v)) for k, v in fields.items())
+    return out
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Tabulate and compare bench_run() results from captured output.")
+    parser.add_argument('logs', nargs='+', help="output of 'test-<variant> bench', one file per run")
+    parser.add_argument('--stat', choices=('min', 'med', 'max'), default='med',
+                        help="statistic to compare across logs (default med)")
+    args = parser.parse_args()
+
+    runs = [(Path(l).name, parse(Path(l).read_text(errors='replace'))) for l in args.logs]
+    names = []
+    for _, r in runs:
+        names += [n for n in r if n not in names]
+    if not names:
+        print("no Bench: lines found")
+        exit(1)
+
+    if len(runs) == 1:
+        r = runs[0][1]
+        print("%-24s %7s %10s %10s %10s %7s" % ("benchmark", "iters", "min us", "med us", "max us", "spread"))
+        for n in names:
+            b = r[n]
+            print("%-24s %7u %10.1f %10.1f %10.1f %6.1f%%" % (n, b['iters'], b['min'], b['med'], b['max'],
+                                                            100.0 * (b['max'] - b['min']) / b['min'] if b['min'] else 0))
+        exit(0)
+
+    # One column per log, relative to the first
+    width = max(12, max(len(l) for l, _ in runs))
+    print("%-24s %s" % ("benchmark (%s us)" % args.stat, ' '.join(l.rjust(width) for l, _ in runs)))
+    base = runs[0][1]
+    for n in names:
+        cells = []
+        for _, r in runs:
+            if n not in r:
+                cells.append('-'.rjust(width))
+            elif r is base or n not in base or not base[n][args.stat]:
+                cells.append(('%.1f' % r[n][args.stat]).rjust(width))
+            else:
+                cells.append(('%.1f %+.0f%%' % (r[n][args.stat],
+                              100.0 * (r[n][args.stat] / base[n][args.stat] - 1))).rjust(width))
+        print("%-24s %s" % (n, ' '.join(cells)))
@@ -0,0 +1,62 @@
+#!/usr/bin/python3
+
+"""Content-defined chunking with a gear rolling hash.
+
+Cut points depend only on the bytes just before them, so an insertion or
+deletion moves the chunk boundaries near it and leaves the rest of the
+chunks, and their hashes, unchanged.
+"""
+
+import hashlib
+
+
+def _gear():
+    table = []
+    for i in range(256):
+        table.append(int.from_bytes(hashlib.sha256(bytes([i])).digest()[:4], "little"))
+    return table
+
+
+GEAR = _gear()
+
+MIN_CHUNK = 64
+AVG_CHUNK = 256         # power of two
+MAX_CHUNK = 2048
+
+
+def boundaries(data, min_size=MIN_CHUNK, avg_size=AVG_CHUNK, max_size=MAX_CHUNK):
+    """(offset, length) of each chunk of data."""
+    mask = avg_size - 1
+    out = []
+    start = 0
+    n = len(data)
+    while start < n:
+        end = min(n, start + max_size)
+        pos = start + min_size
+        h = 0
+        cut = end
+        while pos < end:
+            h = ((h << 1) + GEAR[data[pos]]) & 0xffffffff
+            pos += 1
+            if not (h & mask):
+                cut = pos
+                break
+        out.append((start, cut - start))
+        start = cut
+    return out
+
+
+def digest(data):
+    return hashlib.sha256(data).hexdigest()[:32]
+
+
+def chunk(data, **sizes):
+    """(digest, offset, length) of each chunk of data."""
+    return [(digest(data[o:o + l]), o, l) for o, l in boundaries(data, **sizes)]
+
+
+def similarity(a, b):
+    """Share of bytes in chunks common to both, from {digest: length} maps."""
+    common = sum(l for d, l in a.items() if d in b)
+    total = sum(a.values()) + sum(l for d, l in b.items() if d not in a)
+    return float(common) / total if total else 1.0
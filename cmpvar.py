@@ -0,0 +1,155 @@
+#!/usr/bin/python3
+
+import argparse
+import re
+from pathlib import Path
+from sys import exit
+
+import dis86
+from mapfile import MapFile
+from mzexe import MZExe
+from program import Program
+from wcet import Annotations, Estimator
+
+
+SECTIONS = ('.text', '.data', '.bss')
+
+_FUNC = re.compile(r'^([A-Za-z_.$][\w.$]*):')
+_INSN = re.compile(r'^\t([a-z][a-z0-9]*)\b\s*(.*)$')
+
+# Instructions first available on the 80186, or their 186-only forms
+_EXT186 = ('enter', 'leave', 'pusha', 'popa', 'pushaw', 'popaw', 'bound',
+           'insb', 'insw', 'outsb', 'outsw')
+_SHIFTS = ('shl', 'shr', 'sal', 'sar', 'rol', 'ror', 'rcl', 'rcr')
+
+
+def is_186(mnem, ops):
+    if mnem in _EXT186:
+        return True
+    # Strip the AT&T operand-size suffix
+    base = mnem[:-1] if mnem[-1] in 'bw' and mnem[:-1] in _SHIFTS + ('push', 'imul') else mnem
+    if base in ('push', 'imul'):
+        return ops.startswith('$')
+    if base in _SHIFTS:
+        m = re.match(r'\$(\d+)\s*,', ops)
+        return bool(m) and int(m.group(1)) != 1
+    return False
+
+
+def asm_counts(path):
+    """Per-function (instructions, push/pop, 186+) counts from a gcc -S listing."""
+    counts = {}
+    func = None
+
+    for line in Path(path).read_text().splitlines():
+        m = _FUNC.match(line)
+        if m:
+            # Local .L labels stay within the current function
+            if not m.group(1).startswith('.'):
+                func = m.group(1)
+                counts.setdefault(func, [0, 0, 0])
+            continue
+        m = _INSN.match(line)
+        if m and func is not None:
+            counts[func][0] += 1
+            if m.group(1) in ('push', 'pop', 'pushw', 'popw'):
+                counts[func][1] += 1
+            if is_186(m.group(1), m.group(2)):
+                counts[func][2] += 1
+    return counts
+
+
+def load_variant(spec):
+    parts = spec.split(':')
+    if len(parts) < 2:
+        print("%s: expected NAME:MAP[:ASM...]" % spec)
+        exit(1)
+    name, mapname, asms = parts[0], parts[1], parts[2:]
+    m = MapFile(mapname)
+    exe = Path(mapname).with_suffix('.exe')
+    counts = {}
+    for a in asms:
+        counts.update(asm_counts(a))
+    image = {'exe': 0, 'load': 0, 'funcs': len(m.functions()), 'insns': 0}
+    prog = None
+    if exe.exists():
+        image['exe'] = exe.stat().st_size
+        image['load'] = MZExe.load(exe).load_bytes
+        # Every linked function, runtime included, decoded from the image
+        prog = Program(exe, mapname)
+        image['insns'] = sum(len(prog.insns(f)) for f in prog.functions())
+    image.update((s, m.section_size(s)) for s in SECTIONS)
+    return {'name': name, 'image': image, 'counts': counts, 'prog': prog}
+
+
+def cycles(v, func, ann, bound):
+    """{cpu: (best, worst)} for a listed function in a variant's image, or None.
+    A kernel built per dispatch level is linked as <func>_<level>; the
+    variant's own level is the one named like the variant."""
+    prog = v['prog']
+    sym = prog and (prog.function(func) or prog.function('%s_%s' % (func, v['name'])))
+    if not sym:
+        return None
+    return dict((c, Estimator(prog, ann, c, bound).function(sym)) for c in dis86.CPUS)
+
+
+def delta(v, base, first=False):
+    if first or base == 0:
+        return "%u" % v
+    return "%u %+.1f%%" % (v, 100.0 * (v - base) / base)
+
+
+def report(variants, ann, bound):
+    base = variants[0]
+    names = [v['name'] for v in variants]
+    rows = [('file', 'exe'), ('load', 'load')] + [(s, s) for s in SECTIONS] + [('funcs', 'funcs'), ('insns', 'insns')]
+    width = max(len(r[0]) for r in rows)
+
+    print("Image (bytes, functions and instructions linked):")
+    print(("  %-*s  %s" % (width, '', ''.join("%-16s" % n for n in names))).rstrip())
+    for label, key in rows:
+        line = "  %-*s  " % (width, label)
+        for v in variants:
+            line += "%-16s" % delta(v['image'][key], base['image'][key], v is base)
+        print(line.rstrip())
+
+    funcs = sorted(set().union(*(v['counts'].keys() for v in variants)))
+    if not funcs:
+        return
+    print()
+    print("Instructions (push/pop, 186+) per function:")
+    fw = max(len(f) for f in funcs)
+    print(("  %-*s  %s" % (fw, '', ''.join("%-16s" % n for n in names))).rstrip())
+    for f in funcs:
+        line = "  %-*s  " % (fw, f)
+        for v in variants:
+            n, pp, ext = v['counts'].get(f, (0, 0, 0))
+            line += "%-16s" % ("%u (%u, %u)" % (n, pp, ext))
+        print(line.rstrip())
+
+    # Static estimates from wcet.py's tables; nothing here is measured
+    est = dict((f, [cycles(v, f, ann, bound) for v in variants]) for f in funcs)
+    if not any(any(e) for e in est.values()):
+        print()
+        print("Cycles: no timing comparison, no listed function was found in the images")
+        return
+    for cpu in dis86.CPUS:
+        print()
+        print("Cycles per call on the %s, best..worst (static estimate, wcet.py tables):" % cpu)
+        print(("  %-*s  %s" % (fw, '', ''.join("%-16s" % n for n in names))).rstrip())
+        for f in funcs:
+            line = "  %-*s  " % (fw, f)
+            for e in est[f]:
+                line += "%-16s" % ("%u..%u" % e[cpu] if e else '-')
+            print(line.rstrip())
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Compare build variants by image size and instruction counts.")
+    parser.add_argument('variants', nargs='+', metavar='NAME:MAP[:ASM...]',
+                        help="variant name, its link map and optional gcc -S listings; the first is the baseline")
+    parser.add_argument('--ann', help="wcet.py loop bounds for the cycle estimates")
+    parser.add_argument('--bound', type=int, default=1, metavar='N',
+                        help="iterations assumed for loops and REP prefixes without a bound (default 1)")
+    args = parser.parse_args()
+    report([load_variant(v) for v in args.variants], Annotations(args.ann), args.bound)
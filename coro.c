@@ -0,0 +1,129 @@
+
+#include <stddef.h>
+#include <unistd.h>
+
+#include "coro.h"
+
+enum { CORO_NEW, CORO_READY, CORO_DONE };
+
+struct coro {
+	struct coro *next;	/* ring of spawned coroutines */
+	unsigned sp;		/* saved SP, or the empty stack's top while new */
+	unsigned char state;
+	coro_fn fn;
+	void *arg;
+};
+
+static unsigned pool[CORO_POOL / 2];	/* words, to keep the stacks aligned */
+static unsigned pool_used;
+static struct coro main_coro, *ring, *current;
+static unsigned alive;
+
+static void coro_start(void);
+
+/*
+ * Pushes the registers, stores SP in *save and loads sp. A suspended
+ * coroutine's stack holds the same pushes, made here, so they are popped
+ * and this call returns through the frame it was suspended in; every
+ * suspension is inside this function, so the frames all match. A new
+ * coroutine has nothing to pop: 'fresh' is left set and coro_start() is
+ * called on the empty stack. The caller's own 'fresh' is 0, which is what
+ * the resumed side sees in CX.
+ */
+static __attribute__((noinline)) void coro_switch(unsigned *save, unsigned sp, int fresh) {
+	__asm__ volatile ("pushw %%bp\n\t"
+			  "pushw %%si\n\t"
+			  "pushw %%di\n\t"
+			  "pushw %%ds\n\t"
+			  "pushw %%es\n\t"
+			  "movw %%sp, (%%bx)\n\t"
+			  "movw %%dx, %%sp\n\t"
+			  "testw %%cx, %%cx\n\t"
+			  "jnz 1f\n\t"
+			  "popw %%es\n\t"
+			  "popw %%ds\n\t"
+			  "popw %%di\n\t"
+			  "popw %%si\n\t"
+			  "popw %%bp\n"
+			  "1:"
+			  : "+b" (save), "+d" (sp), "+c" (fresh)
+			  :
+			  : "ax", "memory", "cc");
+	if (fresh)
+		coro_start();
+}
+
+/* Runs the current coroutine's function, then leaves its stack for good */
+static void coro_start(void) {
+	current->fn(current->arg);
+	current->state = CORO_DONE;
+	alive--;
+	coro_yield();
+}
+
+struct coro *coro_spawn(coro_fn fn, void *arg, unsigned stack) {
+	unsigned words = (sizeof (struct coro) + stack + 1) / 2;
+	struct coro *c;
+
+	if (words > CORO_POOL / 2 - pool_used)
+		return NULL;
+	c = (struct coro *)(pool + pool_used);
+	pool_used += words;
+	c->sp = (unsigned)(pool + pool_used);
+	c->state = CORO_NEW;
+	c->fn = fn;
+	c->arg = arg;
+	c->next = ring ? ring->next : c;
+	if (ring)
+		ring->next = c;
+	ring = c;
+	alive++;
+	return c;
+}
+
+void coro_run(void) {
+	if (!ring)
+		return;
+	main_coro.next = ring->next;
+	main_coro.state = CORO_READY;
+	current = &main_coro;
+	coro_yield();
+	current = NULL;
+	ring = NULL;
+	pool_used = 0;
+}
+
+void coro_yield(void) {
+	struct coro *from = current, *to = current;
+	int fresh;
+
+	if (!from)
+		return;
+	if (!alive)
+		to = &main_coro;
+	else
+		do
+			to = to->next;
+		while (to->state == CORO_DONE);
+	if (to == from)
+		return;
+	fresh = to->state == CORO_NEW;
+	to->state = CORO_READY;
+	current = to;
+	coro_switch(&from->sp, to->sp, fresh);
+}
+
+/* DOS handle calls block; the yield after each is where the other stages run */
+int coro_read(int fd, void *buf, unsigned n) {
+	int got = read(fd, buf, n);
+
+	coro_yield();
+	return got;
+}
+
+int coro_write(int fd, const void *buf, unsigned n) {
+	int put = write(fd, buf, n);
+
+	coro_yield();
+	return put;
+}
@@ -0,0 +1,26 @@
+#ifndef CORO_H
+#define CORO_H
+
+/*
+ * Cooperative coroutines for the small and medium models. Each runs on a
+ * stack carved from a static pool in BSS, so SS stays on DGROUP; a switch
+ * saves SP, BP, SI, DI, DS and ES. coro_spawn() adds a coroutine to the
+ * round-robin ring, or returns NULL when the pool is full; coro_run() runs
+ * the ring from the main program until every coroutine has returned, then
+ * frees the pool. coro_yield() passes to the next coroutine, and does
+ * nothing outside coro_run(). coro_read() and coro_write() are the DOS
+ * handle calls followed by a yield, the pipeline's I/O points.
+ */
+#define CORO_POOL	0x1000
+#define CORO_STACK	0x400
+
+struct coro;
+typedef void (*coro_fn)(void *arg);
+
+struct coro *coro_spawn(coro_fn fn, void *arg, unsigned stack);
+void coro_run(void);
+void coro_yield(void);
+int coro_read(int fd, void *buf, unsigned n);
+int coro_write(int fd, const void *buf, unsigned n);
+
+#endif
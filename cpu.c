@@ -0,0 +1,43 @@
+
+#include "cpu.h"
+
+static const char *const names[CPU_TYPES] = {"8086", "186", "286", "386+"};
+
+/* Load FLAGS with 'set' and return what the CPU actually kept. */
+static unsigned probe_flags(unsigned set) {
+	unsigned flags;
+
+	__asm__ volatile ("pushf\n\t"
+			  "pushw %1\n\t"
+			  "popf\n\t"
+			  "pushf\n\t"
+			  "popw %0\n\t"
+			  "popf"
+			  : "=r" (flags) : "r" (set));
+	return flags;
+}
+
+/* The 186 and later mask shift counts to 5 bits, the 8086 does not. */
+static int shift_masked(void) {
+	unsigned v = 1;
+
+	__asm__ ("movb $33, %%cl\n\t"
+		 "shlw %%cl, %0"
+		 : "+r" (v) : : "cx");
+	return v != 0;
+}
+
+int cpu_detect(void) {
+	/* Up to the 186, FLAGS bits 12-15 always read back as set */
+	if ((probe_flags(0x0000) & 0xf000) == 0xf000)
+		return shift_masked() ? CPU_186 : CPU_8086;
+
+	/* In real mode the 286 keeps IOPL and NT (bits 12-14) clear */
+	if ((probe_flags(0x7000) & 0x7000) == 0)
+		return CPU_286;
+	return CPU_386;
+}
+
+const char *cpu_name(int cpu) {
+	return cpu >= 0 && cpu < CPU_TYPES ? names[cpu] : "unknown";
+}
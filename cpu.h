@@ -0,0 +1,15 @@
+#ifndef CPU_H
+#define CPU_H
+
+enum cpu_type {
+	CPU_8086,	/* 8086, 8088 */
+	CPU_186,	/* 80186, 80188, V20, V30 */
+	CPU_286,
+	CPU_386,	/* 386 or later */
+	CPU_TYPES
+};
+
+int cpu_detect(void);
+const char *cpu_name(int cpu);
+
+#endif
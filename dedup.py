@@ -0,0 +1,122 @@
+#!/usr/bin/python3
+
+import argparse
+import random
+from sys import exit
+
+import chunks
+from index import connect
+
+
+class Clusters:
+    """Union-find over artifact ids."""
+
+    def __init__(self):
+        self.parent = {}
+
+    def find(self, a):
+        self.parent.setdefault(a, a)
+        while self.parent[a] != a:
+            self.parent[a] = self.parent[self.parent[a]]
+            a = self.parent[a]
+        return a
+
+    def union(self, a, b):
+        self.parent[self.find(a)] = self.find(b)
+
+    def groups(self):
+        out = {}
+        for a in self.parent:
+            out.setdefault(self.find(a), []).append(a)
+        return [sorted(g) for g in out.values() if len(g) > 1]
+
+
+def load(con):
+    paths, sha, content = {}, {}, {}
+    for aid, path, digest in con.execute("SELECT id, path, sha256 FROM artifacts"):
+        paths[aid] = path
+        sha[aid] = digest
+    for aid, digest, size in con.execute("SELECT artifact, digest, size FROM chunks"):
+        content.setdefault(aid, {})[digest] = size
+    return paths, sha, content
+
+
+# MinHash signatures banded into buckets: contents sharing most of their
+# chunks agree on a whole band with high probability, whatever the number
+# of other artifacts the chunks turn up in
+HASHES = 32
+ROWS = 2
+WINDOW = 8                      # pairs per representative within a bucket
+PRIME = (1 << 61) - 1
+_rnd = random.Random(0)
+PERMS = [(_rnd.randrange(1, PRIME), _rnd.randrange(PRIME)) for _ in range(HASHES)]
+
+
+def signature(digests):
+    xs = [int(d[:15], 16) for d in digests]
+    return [min((m * x + k) % PRIME for x in xs) for m, k in PERMS]
+
+
+def near_duplicates(sha, content, threshold):
+    """Pairs of distinct contents sharing at least 'threshold' of their bytes."""
+    # One representative per distinct content; candidates share a band
+    reps = {}
+    for aid in sorted(content):
+        reps.setdefault(sha[aid], aid)
+    buckets = {}
+    for aid in sorted(reps.values()):
+        sig = signature(content[aid])
+        for band in range(0, HASHES, ROWS):
+            buckets.setdefault((band, tuple(sig[band:band + ROWS])), []).append(aid)
+
+    # Clusters are unions, so a few neighbours in each bucket are enough
+    shared = set()
+    for ids in buckets.values():
+        for i, a in enumerate(ids):
+            for b in ids[i + 1:i + 1 + WINDOW]:
+                shared.add((a, b))
+
+    pairs = []
+    for (a, b) in shared:
+        sim = chunks.similarity(content[a], content[b])
+        if sim >= threshold:
+            pairs.append((a, b, sim))
+    return reps, pairs
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Identical and near-identical artifacts in an index.py database.")
+    parser.add_argument('db')
+    parser.add_argument('--threshold', type=float, default=0.8, help="byte share in common chunks (default 0.8)")
+    args = parser.parse_args()
+
+    con = connect(args.db)
+    paths, sha, content = load(con)
+    if not paths:
+        print("%s: empty index" % args.db)
+        exit(0)
+
+    by_sha = {}
+    for aid in paths:
+        by_sha.setdefault(sha[aid], []).append(aid)
+    print("Identical contents:")
+    for digest, ids in sorted(by_sha.items(), key=lambda kv: -len(kv[1])):
+        if len(ids) > 1:
+            print("  %s  %u copies: %s" % (digest[:16], len(ids), ' '.join(paths[i] for i in sorted(ids))))
+
+    reps, pairs = near_duplicates(sha, content, args.threshold)
+    c = Clusters()
+    for a, b, _ in pairs:
+        c.union(a, b)
+    print()
+    print("Near-duplicate clusters (>= %.0f%% shared bytes):" % (100 * args.threshold))
+    for g in c.groups():
+        print("  %s" % ' '.join(paths[i] for a in g for i in sorted(by_sha[sha[a]])))
+
+    total = sum(sum(content[a].values()) for a in paths if a in content)
+    unique = {}
+    for a in paths:
+        unique.update(content.get(a, {}))
+    print()
+    print("Storage: %u bytes in %u artifacts, %u distinct contents, %u bytes of distinct chunks (%.1f%%)"
+          % (total, len(paths), len(by_sha), sum(unique.values()), 100.0 * sum(unique.values()) / max(1, total)))
@@ -0,0 +1,817 @@
+#!/usr/bin/python3
+
+"""
+Table driven 8086/80186/80286 real-mode disassembler with instruction
+timings for the 8088 and the 286.
+
+Timings follow the Intel data sheets: 8088 memory forms add the effective
+address calculation and 4 clocks per word transferred over the 8-bit bus,
+286 timings assume no wait states. Ranges (MUL, DIV) and branches carry a
+best and worst figure: for conditional branches best is not taken, worst is
+taken. REP string instructions carry a per-iteration figure in 'rep'.
+"""
+
+CPUS = ('8088', '286')
+
+REG8 = ('al', 'cl', 'dl', 'bl', 'ah', 'ch', 'dh', 'bh')
+REG16 = ('ax', 'cx', 'dx', 'bx', 'sp', 'bp', 'si', 'di')
+REG32 = ('eax', 'ecx', 'edx', 'ebx', 'esp', 'ebp', 'esi', 'edi')
+SREG = ('es', 'cs', 'ss', 'ds')
+RM16 = ('bx+si', 'bx+di', 'bp+si', 'bp+di', 'si', 'di', 'bp', 'bx')
+
+# 8088 effective address clocks for mod 00 and for mod 01/10
+EA_NODISP = (7, 8, 8, 7, 5, 5, 6, 5)
+EA_DISP = (11, 12, 12, 11, 9, 9, 9, 9)
+
+JCC = ('jo', 'jno', 'jb', 'jae', 'je', 'jne', 'jbe', 'ja',
+       'js', 'jns', 'jp', 'jnp', 'jl', 'jge', 'jle', 'jg')
+ALU = ('add', 'or', 'adc', 'sbb', 'and', 'sub', 'xor', 'cmp')
+SHIFT = ('rol', 'ror', 'rcl', 'rcr', 'shl', 'shr', 'sal', 'sar')
+
+# Instruction classes used for histograms and control flow
+K_OTHER = 'other'
+K_JMP = 'jmp'           # near/short direct jump
+K_JCC = 'jcc'           # conditional, LOOP and JCXZ
+K_JMPI = 'jmp-indirect'
+K_JMPF = 'jmp-far'
+K_CALL = 'call'
+K_CALLI = 'call-indirect'
+K_CALLF = 'call-far'
+K_RET = 'ret'
+K_RETF = 'retf'
+K_IRET = 'iret'
+K_INT = 'int'
+K_STRING = 'string'
+K_HLT = 'hlt'
+K_BAD = 'bad'
+
+ENDS_BLOCK = (K_JMP, K_JCC, K_JMPI, K_JMPF, K_RET, K_RETF, K_IRET, K_HLT, K_BAD)
+NO_FALLTHROUGH = (K_JMP, K_JMPI, K_JMPF, K_RET, K_RETF, K_IRET, K_HLT, K_BAD)
+
+# (8088 reg, 8088 mem, word transfers, 286 reg, 286 mem); mem adds EA on 8088
+T = {
+    'alu':      (3, 16, 2, 2, 7),       # r/m, r  (mem is read-modify-write)
+    'alu_rm':   (3, 9, 1, 2, 7),        # r, r/m
+    'alu_i':    (4, 17, 2, 3, 7),       # r/m, imm
+    'cmp':      (3, 9, 1, 2, 6),
+    'cmp_i':    (4, 10, 1, 3, 6),
+    'test':     (3, 9, 1, 2, 6),
+    'test_i':   (5, 11, 1, 3, 6),
+    'mov_rm':   (2, 8, 1, 2, 5),        # r, r/m
+    'mov_mr':   (2, 9, 1, 2, 3),        # r/m, r
+    'mov_i':    (4, 10, 1, 2, 3),
+    'mov_sr':   (2, 8, 1, 2, 5),        # sreg, r/m
+    'mov_rs':   (2, 9, 1, 2, 3),        # r/m, sreg
+    'incdec':   (3, 15, 2, 2, 7),
+    'negnot':   (3, 16, 2, 2, 7),
+    'sh1':      (2, 15, 2, 2, 7),
+    'sh_cl':    (8, 20, 2, 5, 8),       # r/m, CL: base, plus 4 (8088) or 1 (286) per bit
+    'lea':      (2, 2, 0, 3, 3),
+    'lptr':     (16, 16, 2, 7, 7),      # LDS, LES
+    'xchg':     (4, 17, 2, 3, 5),
+    'push':     (15, 24, 0, 3, 5),
+    'pop':      (12, 25, 0, 5, 5),
+    'jmp_i':    (11, 18, 1, 7, 11),
+    'jmpf_i':   (24, 24, 2, 11, 15),
+    'call_i':   (20, 29, 1, 7, 11),
+    'callf_i':  (53, 53, 2, 16, 16),
+    'esc':      (2, 8, 0, 9, 9),
+}
+
+# Fixed clocks of forms without a ModRM operand: (8088, 286)
+F = {
+    'alu_acc':  (4, 3),
+    'mov_acc':  (14, 5),                # word; byte is 4 less on the 8088
+    'mov_ri':   (4, 2),
+    'push_r':   (15, 3),
+    'pop_r':    (12, 5),
+    'push_s':   (14, 3),
+    'pop_s':    (12, 5),
+    'push_i':   (None, 3),
+    'incdec_r': (3, 2),
+    'xchg_ax':  (3, 3),
+    'jmp':      (15, 7),
+    'jmpf':     (15, 11),
+    'call':     (23, 7),
+    'callf':    (36, 13),
+    'ret':      (20, 11),
+    'ret_i':    (24, 11),
+    'retf':     (34, 15),
+    'retf_i':   (33, 15),
+    'iret':     (44, 17),
+    'int':      (71, 23),
+    'int3':     (72, 23),
+    'flag':     (2, 2),
+    'cbw':      (2, 2),
+    'cwd':      (5, 2),
+    'lahf':     (4, 2),
+    'sahf':     (4, 2),
+    'pushf':    (14, 3),
+    'popf':     (12, 5),
+    'nop':      (3, 3),
+    'hlt':      (2, 2),
+    'wait':     (3, 3),
+    'xlat':     (11, 5),
+    'aaa':      (8, 3),
+    'daa':      (4, 3),
+    'aam':      (83, 16),
+    'aad':      (60, 14),
+    'in_i':     (14, 5),
+    'in_dx':    (12, 5),
+    'out_i':    (14, 3),
+    'out_dx':   (12, 3),
+    'leave':    (None, 5),
+    'pusha':    (None, 17),
+    'popa':     (None, 19),
+    'enter':    (None, 11),
+    'bound':    (None, 13),
+    'salc':     (3, 3),
+}
+
+# Branches: (8088 not taken, 8088 taken, 286 not taken, 286 taken)
+BR = {
+    'jcc':      (4, 16, 3, 7),
+    'loop':     (5, 17, 4, 8),
+    'loope':    (6, 18, 4, 8),
+    'loopne':   (5, 19, 4, 8),
+    'jcxz':     (6, 18, 4, 8),
+}
+
+# String ops: (8088 single, 8088 per REP iteration, 286 single, 286 per REP
+# iteration), byte then word; REP adds 9 (8088) or 5 (286) once
+STR = {
+    'movs':     ((18, 17, 5, 4), (26, 25, 5, 4)),
+    'cmps':     ((22, 22, 8, 9), (30, 30, 8, 9)),
+    'stos':     ((11, 10, 3, 3), (15, 14, 3, 3)),
+    'lods':     ((12, 13, 5, 4), (16, 17, 5, 4)),
+    'scas':     ((15, 15, 7, 8), (19, 19, 7, 8)),
+    'ins':      ((None, None, 5, 4), (None, None, 5, 4)),
+    'outs':     ((None, None, 5, 4), (None, None, 5, 4)),
+}
+
+# MUL/IMUL/DIV/IDIV register forms (8088 lo, hi, 286); memory adds EA, 4/word
+MULDIV = {
+    'mul':  ((70, 77, 13), (118, 133, 21)),
+    'imul': ((80, 98, 13), (128, 154, 21)),
+    'div':  ((80, 90, 14), (144, 162, 22)),
+    'idiv': ((101, 112, 17), (165, 184, 25)),
+}
+
+
+class Insn:
+    def __init__(self, addr):
+        self.addr = addr
+        self.size = 0
+        self.raw = b''
+        self.prefix = []
+        self.mnem = '(bad)'
+        self.ops = []
+        self.kind = K_OTHER
+        self.target = None      # near branch or call target
+        self.far = None         # (segment, offset) of a direct far jump/call
+        self.segov = False
+        self.rep = None         # per-iteration clocks of a REP string op
+        self.i386 = False       # needs a 386 (66h/67h prefix)
+        self.needs186 = False
+        self.cycles = dict((c, (None, None)) for c in CPUS)
+
+    @property
+    def end(self):
+        return self.addr + self.size
+
+    def text(self):
+        s = ' '.join(self.prefix + [self.mnem])
+        if self.ops:
+            s += ' ' + ', '.join(self.ops)
+        return s
+
+    def cyc(self, cpu, worst=False):
+        lo, hi = self.cycles[cpu]
+        return hi if worst else lo
+
+    def __str__(self):
+        return self.text()
+
+
+class _Reader:
+    def __init__(self, code, pos):
+        self.code = code
+        self.pos = pos
+        self.start = pos
+
+    def u8(self):
+        if self.pos >= len(self.code):
+            raise IndexError
+        b = self.code[self.pos]
+        self.pos += 1
+        return b
+
+    def s8(self):
+        b = self.u8()
+        return b - 0x100 if b & 0x80 else b
+
+    def u16(self):
+        return self.u8() | (self.u8() << 8)
+
+    def s16(self):
+        w = self.u16()
+        return w - 0x10000 if w & 0x8000 else w
+
+    def u32(self):
+        return self.u16() | (self.u16() << 16)
+
+
+def _hex(v):
+    return '0x%x' % v if v > 9 or v < 0 else '%d' % v
+
+
+class _ModRM:
+    def __init__(self, rd, seg, wide32):
+        b = rd.u8()
+        self.mod = b >> 6
+        self.reg = (b >> 3) & 7
+        self.rm = b & 7
+        self.disp = 0
+        self.mem = self.mod != 3
+        self.seg = seg
+        self.wide32 = wide32
+        if self.mod == 0 and self.rm == 6:
+            self.disp = rd.u16()
+        elif self.mod == 1:
+            self.disp = rd.s8()
+        elif self.mod == 2:
+            self.disp = rd.s16()
+
+    def ea_cycles(self):
+        if not self.mem:
+            return 0
+        if self.mod == 0:
+            c = EA_NODISP[self.rm]
+        else:
+            c = EA_DISP[self.rm]
+        return c + (2 if self.seg else 0)
+
+    def ea286(self):
+        return 1 if self.mem and self.mod != 0 and self.rm < 4 else 0
+
+    def operand(self, size):
+        if not self.mem:
+            return {8: REG8, 16: REG16, 32: REG32}[size][self.rm]
+        if self.mod == 0 and self.rm == 6:
+            addr = '0x%04x' % self.disp
+        else:
+            addr = RM16[self.rm]
+            if self.disp > 0:
+                addr += '+' + _hex(self.disp)
+            elif self.disp < 0:
+                addr += '-' + _hex(-self.disp)
+        seg = self.seg + ':' if self.seg else ''
+        return '%s [%s%s]' % ({8: 'byte', 16: 'word', 32: 'dword'}[size], seg, addr)
+
+    def reg_operand(self, size):
+        return {8: REG8, 16: REG16, 32: REG32}[size][self.reg]
+
+
+def _timed(insn, key, m, word):
+    """Set insn cycles from table T for a ModRM form."""
+    r88, m88, xfer, r286, m286 = T[key]
+    if m.mem:
+        c88 = m88 + m.ea_cycles() + (4 * xfer if word else 0)
+        c286 = m286 + m.ea286()
+    else:
+        c88, c286 = r88, r286
+    insn.cycles = {'8088': (c88, c88), '286': (c286, c286)}
+
+
+def _fixed(insn, key, adj88=0):
+    c88, c286 = F[key]
+    if c88 is not None:
+        c88 += adj88
+    insn.cycles = {'8088': (c88, c88), '286': (c286, c286)}
+    if c88 is None:
+        insn.needs186 = True
+
+
+def decode(code, pos, addr=None):
+    """Decode one instruction at code[pos]; addr is its offset in the segment."""
+    if addr is None:
+        addr = pos
+    insn = Insn(addr)
+    rd = _Reader(code, pos)
+    try:
+        _decode(insn, rd)
+    except IndexError:
+        insn.mnem = '(bad)'
+        insn.kind = K_BAD
+        insn.ops = []
+        rd.pos = min(len(code), rd.start + 1)
+    if insn.i386:
+        # Neither timed CPU can execute a 66h/67h prefixed instruction
+        insn.cycles = dict((c, (None, None)) for c in CPUS)
+        insn.rep = None
+    insn.size = rd.pos - rd.start
+    insn.raw = bytes(code[rd.start:rd.pos])
+    return insn
+
+
+def _decode(insn, rd):
+    seg = None
+    osize = 16
+    rep = None
+    while True:
+        op = rd.u8()
+        if op in (0x26, 0x2e, 0x36, 0x3e):
+            seg = SREG[(op >> 3) & 3]
+            insn.segov = True
+        elif op in (0xf2, 0xf3):
+            rep = op
+        elif op == 0xf0:
+            insn.prefix.append('lock')
+        elif op == 0x66:
+            osize = 32
+            insn.i386 = True
+        elif op == 0x67:
+            insn.i386 = True
+        else:
+            break
+
+    w = op & 1
+    size = (osize if w else 8)
+
+    def imm(sz):
+        return rd.u8() if sz == 8 else (rd.u32() if sz == 32 else rd.u16())
+
+    def rel(sz):
+        d = rd.s8() if sz == 8 else rd.s16()
+        return (insn.addr + (rd.pos - rd.start) + d) & 0xffff
+
+    if op == 0x0f:
+        # POP CS on the 8086; 286 system instructions and 386 extensions later
+        insn.mnem = '(0f %02x)' % rd.u8()
+        insn.kind = K_BAD
+        return
+
+    # ALU r/m,r  r,r/m  acc,imm
+    if op < 0x40 and (op & 7) < 6:
+        name = ALU[op >> 3]
+        form = op & 7
+        insn.mnem = name
+        if form < 4:
+            m = _ModRM(rd, seg, osize == 32)
+            r, e = m.reg_operand(size), m.operand(size)
+            insn.ops = [e, r] if form < 2 else [r, e]
+            key = 'cmp' if name == 'cmp' else ('alu' if form < 2 else 'alu_rm')
+            _timed(insn, key, m, w)
+        else:
+            insn.ops = ['al' if not w else ('eax' if osize == 32 else 'ax'), _hex(imm(size))]
+            _fixed(insn, 'alu_acc')
+        return
+
+    if op < 0x40:
+        low = op & 7
+        if low in (6, 7) and op < 0x20:
+            insn.mnem = 'push' if low == 6 else 'pop'
+            insn.ops = [SREG[op >> 3]]
+            _fixed(insn, 'push_s' if low == 6 else 'pop_s')
+            return
+        # 26/2e/36/3e handled as prefixes; 27 daa 2f das 37 aaa 3f aas
+        insn.mnem = {0x27: 'daa', 0x2f: 'das', 0x37: 'aaa', 0x3f: 'aas'}.get(op, '(bad)')
+        if insn.mnem == '(bad)':
+            insn.kind = K_BAD
+            return
+        _fixed(insn, 'daa' if op in (0x27, 0x2f) else 'aaa')
+        return
+
+    regs = REG32 if osize == 32 else REG16
+    if op < 0x50:
+        insn.mnem = 'inc' if op < 0x48 else 'dec'
+        insn.ops = [regs[op & 7]]
+        _fixed(insn, 'incdec_r')
+        return
+    if op < 0x60:
+        insn.mnem = 'push' if op < 0x58 else 'pop'
+        insn.ops = [regs[op & 7]]
+        _fixed(insn, 'push_r' if op < 0x58 else 'pop_r')
+        return
+    if op == 0x60 or op == 0x61:
+        insn.mnem = 'pusha' if op == 0x60 else 'popa'
+        _fixed(insn, insn.mnem)
+        return
+    if op == 0x62:
+        m = _ModRM(rd, seg, False)
+        insn.mnem = 'bound'
+        insn.ops = [m.reg_operand(16), m.operand(16)]
+        _fixed(insn, 'bound')
+        return
+    if op in (0x68, 0x6a):
+        insn.mnem = 'push'
+        insn.ops = [_hex(imm(osize) if op == 0x68 else rd.s8() & 0xffff)]
+        _fixed(insn, 'push_i')
+        return
+    if op in (0x69, 0x6b):
+        m = _ModRM(rd, seg, osize == 32)
+        insn.mnem = 'imul'
+        v = imm(osize) if op == 0x69 else rd.s8()
+        insn.ops = [m.reg_operand(osize), m.operand(osize), _hex(v)]
+        c = 21 + (3 if m.mem else 0)
+        insn.cycles = {'8088': (None, None), '286': (c, c)}
+        insn.needs186 = True
+        return
+    if 0x6c <= op <= 0x6f:
+        insn.mnem = ('ins' if op < 0x6e else 'outs') + ('w' if w else 'b')
+        _string(insn, 'ins' if op < 0x6e else 'outs', w, rep)
+        insn.needs186 = True
+        return
+    if op < 0x80:
+        insn.mnem = JCC[op & 15]
+        insn.target = rel(8)
+        insn.ops = ['0x%04x' % insn.target]
+        insn.kind = K_JCC
+        _branch(insn, 'jcc')
+        return
+    if op < 0x84:
+        m = _ModRM(rd, seg, osize == 32)
+        name = ALU[m.reg]
+        insn.mnem = name
+        sz = 8 if op in (0x80, 0x82) else osize
+        v = rd.s8() & (0xffff if sz != 8 else 0xff) if op == 0x83 else imm(sz)
+        insn.ops = [m.operand(sz), _hex(v)]
+        _timed(insn, 'cmp_i' if name == 'cmp' else 'alu_i', m, sz != 8)
+        return
+    if op < 0x86:
+        m = _ModRM(rd, seg, osize == 32)
+        insn.mnem = 'test'
+        insn.ops = [m.operand(size), m.reg_operand(size)]
+        _timed(insn, 'test', m, w)
+        return
+    if op < 0x88:
+        m = _ModRM(rd, seg, osize == 32)
+        insn.mnem = 'xchg'
+        insn.ops = [m.operand(size), m.reg_operand(size)]
+        _timed(insn, 'xchg', m, w)
+        return
+    if op < 0x8c:
+        m = _ModRM(rd, seg, osize == 32)
+        insn.mnem = 'mov'
+        r, e = m.reg_operand(size), m.operand(size)
+        if op < 0x8a:
+            insn.ops = [e, r]
+            _timed(insn, 'mov_mr', m, w)
+        else:
+            insn.ops = [r, e]
+            _timed(insn, 'mov_rm', m, w)
+        return
+    if op in (0x8c, 0x8e):
+        m = _ModRM(rd, seg, False)
+        insn.mnem = 'mov'
+        s, e = SREG[m.reg & 3], m.operand(16)
+        insn.ops = [e, s] if op == 0x8c else [s, e]
+        _timed(insn, 'mov_rs' if op == 0x8c else 'mov_sr', m, True)
+        return
+    if op == 0x8d:
+        m = _ModRM(rd, seg, osize == 32)
+        insn.mnem = 'lea'
+        insn.ops = [m.reg_operand(osize), m.operand(osize).split(' ', 1)[1]]
+        _timed(insn, 'lea', m, False)
+        if m.mem:
+            c = 2 + m.ea_cycles()
+            insn.cycles['8088'] = (c, c)
+        return
+    if op == 0x8f:
+        m = _ModRM(rd, seg, osize == 32)
+        insn.mnem = 'pop'
+        insn.ops = [m.operand(osize)]
+        _timed(insn, 'pop', m, True)
+        return
+    if op == 0x90:
+        insn.mnem = 'nop'
+        _fixed(insn, 'nop')
+        return
+    if op < 0x98:
+        insn.mnem = 'xchg'
+        insn.ops = [regs[0], regs[op & 7]]
+        _fixed(insn, 'xchg_ax')
+        return
+    if op == 0x98:
+        insn.mnem = 'cwde' if osize == 32 else 'cbw'
+        _fixed(insn, 'cbw')
+        return
+    if op == 0x99:
+        insn.mnem = 'cdq' if osize == 32 else 'cwd'
+        _fixed(insn, 'cwd')
+        return
+    if op == 0x9a:
+        off = rd.u16()
+        sg = rd.u16()
+        insn.mnem = 'call'
+        insn.ops = ['0x%04x:0x%04x' % (sg, off)]
+        insn.far = (sg, off)
+        insn.kind = K_CALLF
+        _fixed(insn, 'callf')
+        return
+    if op == 0x9b:
+        insn.mnem = 'wait'
+        _fixed(insn, 'wait')
+        return
+    if op in (0x9c, 0x9d):
+        insn.mnem = ('pushf' if op == 0x9c else 'popf') + ('d' if osize == 32 else '')
+        _fixed(insn, 'pushf' if op == 0x9c else 'popf')
+        return
+    if op in (0x9e, 0x9f):
+        insn.mnem = 'sahf' if op == 0x9e else 'lahf'
+        _fixed(insn, insn.mnem)
+        return
+    if op < 0xa4:
+        off = rd.u16()
+        acc = 'al' if not w else regs[0]
+        mem = '%s [%s0x%04x]' % ('byte' if not w else 'word', seg + ':' if seg else '', off)
+        insn.mnem = 'mov'
+        insn.ops = [acc, mem] if op < 0xa2 else [mem, acc]
+        _fixed(insn, 'mov_acc', (0 if w else -4) + (2 if seg else 0))
+        return
+    if op < 0xb0 and op not in (0xa8, 0xa9):
+        name = {0xa4: 'movs', 0xa6: 'cmps', 0xaa: 'stos', 0xac: 'lods', 0xae: 'scas'}[op & 0xfe]
+        insn.mnem = name + ('b' if not w else ('d' if osize == 32 else 'w'))
+        _string(insn, name, w, rep)
+        if seg:
+            insn.ops = [seg + ':']
+        return
+    if op in (0xa8, 0xa9):
+        insn.mnem = 'test'
+        insn.ops = ['al' if not w else regs[0], _hex(imm(size))]
+        _fixed(insn, 'alu_acc')
+        return
+    if op < 0xb8:
+        insn.mnem = 'mov'
+        insn.ops = [REG8[op & 7], _hex(rd.u8())]
+        _fixed(insn, 'mov_ri')
+        return
+    if op < 0xc0:
+        insn.mnem = 'mov'
+        insn.ops = [regs[op & 7], _hex(imm(osize))]
+        _fixed(insn, 'mov_ri')
+        return
+    if op in (0xc0, 0xc1, 0xd0, 0xd1, 0xd2, 0xd3):
+        m = _ModRM(rd, seg, osize == 32)
+        insn.mnem = SHIFT[m.reg]
+        sz = size if op & 1 else 8
+        if op in (0xc0, 0xc1):
+            n = rd.u8()
+            insn.ops = [m.operand(sz), _hex(n)]
+            c = (8 if m.mem else 5) + (n & 31)
+            insn.cycles = {'8088': (None, None), '286': (c, c)}
+            insn.needs186 = True
+        elif op in (0xd0, 0xd1):
+            insn.ops = [m.operand(sz), '1']
+            _timed(insn, 'sh1', m, sz != 8)
+        else:
+            insn.ops = [m.operand(sz), 'cl']
+            # CL is unknown: best assumes a count of 1, worst 15 (31 on 286)
+            _timed(insn, 'sh_cl', m, sz != 8)
+            base88, base286 = insn.cycles['8088'][0], insn.cycles['286'][0]
+            insn.cycles = {'8088': (base88 + 4, base88 + 4 * 15), '286': (base286 + 1, base286 + 31)}
+        return
+    if op in (0xc2, 0xc3):
+        insn.mnem = 'ret'
+        if op == 0xc2:
+            insn.ops = [_hex(rd.u16())]
+        insn.kind = K_RET
+        _fixed(insn, 'ret_i' if op == 0xc2 else 'ret')
+        return
+    if op in (0xc4, 0xc5):
+        m = _ModRM(rd, seg, False)
+        insn.mnem = 'les' if op == 0xc4 else 'lds'
+        insn.ops = [m.reg_operand(16), m.operand(16).split(' ', 1)[1]]
+        _timed(insn, 'lptr', m, True)
+        if m.mem:
+            c = 16 + m.ea_cycles() + 8
+            insn.cycles['8088'] = (c, c)
+        return
+    if op in (0xc6, 0xc7):
+        m = _ModRM(rd, seg, osize == 32)
+        insn.mnem = 'mov'
+        insn.ops = [m.operand(size), _hex(imm(size))]
+        _timed(insn, 'mov_i', m, w)
+        return
+    if op == 0xc8:
+        n = rd.u16()
+        lvl = rd.u8()
+        insn.mnem = 'enter'
+        insn.ops = [_hex(n), _hex(lvl)]
+        _fixed(insn, 'enter')
+        if lvl:
+            c = 12 + 4 * (lvl - 1) if lvl > 1 else 12
+            insn.cycles['286'] = (c, c)
+        return
+    if op == 0xc9:
+        insn.mnem = 'leave'
+        _fixed(insn, 'leave')
+        return
+    if op in (0xca, 0xcb):
+        insn.mnem = 'retf'
+        if op == 0xca:
+            insn.ops = [_hex(rd.u16())]
+        insn.kind = K_RETF
+        _fixed(insn, 'retf_i' if op == 0xca else 'retf')
+        return
+    if op == 0xcc:
+        insn.mnem = 'int3'
+        insn.kind = K_INT
+        _fixed(insn, 'int3')
+        return
+    if op == 0xcd:
+        insn.mnem = 'int'
+        insn.ops = ['0x%02x' % rd.u8()]
+        insn.kind = K_INT
+        _fixed(insn, 'int')
+        return
+    if op == 0xce:
+        insn.mnem = 'into'
+        insn.cycles = {'8088': (4, 73), '286': (3, 24)}
+        return
+    if op == 0xcf:
+        insn.mnem = 'iret'
+        insn.kind = K_IRET
+        _fixed(insn, 'iret')
+        return
+    if op in (0xd4, 0xd5):
+        rd.u8()
+        insn.mnem = 'aam' if op == 0xd4 else 'aad'
+        _fixed(insn, insn.mnem)
+        return
+    if op == 0xd6:
+        insn.mnem = 'salc'
+        _fixed(insn, 'salc')
+        return
+    if op == 0xd7:
+        insn.mnem = 'xlat'
+        _fixed(insn, 'xlat', 2 if seg else 0)
+        return
+    if op < 0xe0:
+        m = _ModRM(rd, seg, False)
+        insn.mnem = 'esc'
+        insn.ops = ['0x%02x' % (((op & 7) << 3) | m.reg), m.operand(16) if m.mem else REG16[m.rm]]
+        _timed(insn, 'esc', m, False)
+        return
+    if op < 0xe4:
+        insn.mnem = ('loopne', 'loope', 'loop', 'jcxz')[op & 3]
+        insn.target = rel(8)
+        insn.ops = ['0x%04x' % insn.target]
+        insn.kind = K_JCC
+        _branch(insn, insn.mnem)
+        return
+    if op < 0xe8:
+        acc = 'al' if not w else regs[0]
+        port = '0x%02x' % rd.u8()
+        if op < 0xe6:
+            insn.mnem, insn.ops = 'in', [acc, port]
+            _fixed(insn, 'in_i', 0 if w else -4)
+        else:
+            insn.mnem, insn.ops = 'out', [port, acc]
+            _fixed(insn, 'out_i', 0 if w else -4)
+        return
+    if op == 0xe8:
+        insn.mnem = 'call'
+        insn.target = rel(16)
+        insn.ops = ['0x%04x' % insn.target]
+        insn.kind = K_CALL
+        _fixed(insn, 'call')
+        return
+    if op in (0xe9, 0xeb):
+        insn.mnem = 'jmp'
+        insn.target = rel(16 if op == 0xe9 else 8)
+        insn.ops = ['0x%04x' % insn.target]
+        insn.kind = K_JMP
+        _fixed(insn, 'jmp')
+        return
+    if op == 0xea:
+        off = rd.u16()
+        sg = rd.u16()
+        insn.mnem = 'jmp'
+        insn.ops = ['0x%04x:0x%04x' % (sg, off)]
+        insn.far = (sg, off)
+        insn.kind = K_JMPF
+        _fixed(insn, 'jmpf')
+        return
+    if op < 0xf0:
+        acc = 'al' if not w else regs[0]
+        if op < 0xee:
+            insn.mnem, insn.ops = 'in', [acc, 'dx']
+            _fixed(insn, 'in_dx', 0 if w else -4)
+        else:
+            insn.mnem, insn.ops = 'out', ['dx', acc]
+            _fixed(insn, 'out_dx', 0 if w else -4)
+        return
+    if op == 0xf4:
+        insn.mnem = 'hlt'
+        insn.kind = K_HLT
+        _fixed(insn, 'hlt')
+        return
+    if op == 0xf5:
+        insn.mnem = 'cmc'
+        _fixed(insn, 'flag')
+        return
+    if op in (0xf6, 0xf7):
+        m = _ModRM(rd, seg, osize == 32)
+        sub = m.reg
+        if sub < 2:
+            insn.mnem = 'test'
+            insn.ops = [m.operand(size), _hex(imm(size))]
+            _timed(insn, 'test_i', m, w)
+        elif sub < 4:
+            insn.mnem = ('not', 'neg')[sub - 2]
+            insn.ops = [m.operand(size)]
+            _timed(insn, 'negnot', m, w)
+        else:
+            insn.mnem = ('mul', 'imul', 'div', 'idiv')[sub - 4]
+            insn.ops = [m.operand(size)]
+            lo, hi, c286 = MULDIV[insn.mnem][w]
+            if m.mem:
+                extra = m.ea_cycles() + (4 if w else 0) + 6
+                lo, hi, c286 = lo + extra, hi + extra, c286 + 3
+            insn.cycles = {'8088': (lo, hi), '286': (c286, c286)}
+        return
+    if 0xf8 <= op <= 0xfd:
+        insn.mnem = ('clc', 'stc', 'cli', 'sti', 'cld', 'std')[op - 0xf8]
+        _fixed(insn, 'flag')
+        return
+    if op == 0xfe:
+        m = _ModRM(rd, seg, False)
+        if m.reg > 1:
+            insn.kind = K_BAD
+            return
+        insn.mnem = ('inc', 'dec')[m.reg]
+        insn.ops = [m.operand(8)]
+        _timed(insn, 'incdec', m, False)
+        return
+    if op == 0xff:
+        m = _ModRM(rd, seg, osize == 32)
+        sub = m.reg
+        if sub < 2:
+            insn.mnem = ('inc', 'dec')[sub]
+            insn.ops = [m.operand(osize)]
+            _timed(insn, 'incdec', m, True)
+        elif sub == 2:
+            insn.mnem = 'call'
+            insn.ops = [m.operand(16)]
+            insn.kind = K_CALLI
+            _timed(insn, 'call_i', m, True)
+        elif sub == 3:
+            insn.mnem = 'call'
+            insn.ops = ['far ' + m.operand(16).split(' ', 1)[1]]
+            insn.kind = K_CALLI
+            _timed(insn, 'callf_i', m, True)
+            if m.mem:
+                c = 53 + m.ea_cycles()
+                insn.cycles['8088'] = (c, c)
+        elif sub == 4:
+            insn.mnem = 'jmp'
+            insn.ops = [m.operand(16)]
+            insn.kind = K_JMPI
+            _timed(insn, 'jmp_i', m, True)
+        elif sub == 5:
+            insn.mnem = 'jmp'
+            insn.ops = ['far ' + m.operand(16).split(' ', 1)[1]]
+            insn.kind = K_JMPI
+            _timed(insn, 'jmpf_i', m, True)
+        elif sub == 6:
+            insn.mnem = 'push'
+            insn.ops = [m.operand(osize)]
+            _timed(insn, 'push', m, True)
+        else:
+            insn.kind = K_BAD
+        return
+    insn.kind = K_BAD
+
+
+def _branch(insn, key):
+    n88, t88, n286, t286 = BR[key]
+    insn.cycles = {'8088': (n88, t88), '286': (n286, t286)}
+
+
+def _string(insn, name, w, rep):
+    s88, r88, s286, r286 = STR[name][w]
+    insn.kind = K_STRING
+    if rep is None:
+        insn.cycles = {'8088': (s88, s88), '286': (s286, s286)}
+        if s88 is None:
+            insn.cycles['8088'] = (None, None)
+        return
+    if name in ('cmps', 'scas'):
+        insn.prefix.append('repe' if rep == 0xf3 else 'repne')
+    else:
+        insn.prefix.append('rep')
+    base88 = 9 if r88 is not None else None
+    insn.cycles = {'8088': (base88, base88), '286': (5, 5)}
+    insn.rep = {'8088': r88, '286': r286}
+
+
+def disassemble(code, start, end, base=0):
+    """Decode code[start:end]; instruction addresses are offset by base."""
+    out = []
+    pos = start
+    while pos < end:
+        insn = decode(code, pos, base + pos)
+        out.append(insn)
+        pos += max(1, insn.size)
+    return out
@@ -0,0 +1,111 @@
+
+#include <i86.h>
+#include <string.h>
+
+#include "dosmem.h"
+
+/* EXEC (4B00h) parameter block */
+struct exec_block {
+	unsigned env;		/* 0: copy of the parent's */
+	void __far *tail;
+	void __far *fcb1;
+	void __far *fcb2;
+};
+
+unsigned dos_psp(void) {
+	union REGS r;
+
+	r.h.ah = 0x62;
+	int86(0x21, &r, &r);
+	return r.w.bx;
+}
+
+/* From the memory control block just below the PSP */
+unsigned dos_block_size(void) {
+	return *(unsigned __far *)MK_FP(dos_psp() - 1, 3);
+}
+
+/* An allocation that cannot succeed reports the largest free block */
+unsigned dos_largest_free(void) {
+	union REGS r;
+
+	r.h.ah = 0x48;
+	r.w.bx = 0xffff;
+	int86(0x21, &r, &r);
+	return r.w.bx;
+}
+
+/* Returns the segment of the new block, or 0 */
+unsigned dos_alloc(unsigned paras) {
+	union REGS r;
+
+	r.h.ah = 0x48;
+	r.w.bx = paras;
+	int86(0x21, &r, &r);
+	return r.w.cflag ? 0 : r.w.ax;
+}
+
+void dos_free(unsigned seg) {
+	union REGS r;
+	struct SREGS sr;
+
+	segread(&sr);
+	r.h.ah = 0x49;
+	sr.es = seg;
+	int86x(0x21, &r, &r, &sr);
+}
+
+/*
+ * Give back what the header's max-alloc took beyond the end of the stack
+ * segment: the heap and stack share DGROUP, so nothing past SS:FFFF is
+ * used. Returns 0, or -1 if DOS refused.
+ */
+int dos_shrink(void) {
+	union REGS r;
+	struct SREGS sr;
+	unsigned psp = dos_psp(), need;
+
+	segread(&sr);
+	need = sr.ss + 0x1000 - psp;
+	if (need >= dos_block_size())
+		return 0;
+	r.h.ah = 0x4a;
+	r.w.bx = need;
+	sr.es = psp;
+	int86x(0x21, &r, &r, &sr);
+	return r.w.cflag ? -1 : 0;
+}
+
+/* Run a program and wait for it; returns its exit code or -1 */
+int dos_exec(const char *path, const char *args) {
+	static char tail[128];
+	static char fcb[16];
+	struct exec_block pb;
+	union REGS r;
+	struct SREGS sr;
+	unsigned n = strlen(args);
+
+	if (n > sizeof tail - 3)
+		n = sizeof tail - 3;
+	tail[0] = n + 1;
+	tail[1] = ' ';
+	memcpy(tail + 2, args, n);
+	tail[n + 2] = '\r';
+
+	segread(&sr);
+	pb.env = 0;
+	pb.tail = MK_FP(sr.ds, (unsigned)tail);
+	pb.fcb1 = pb.fcb2 = MK_FP(sr.ds, (unsigned)fcb);
+
+	r.w.ax = 0x4b00;
+	r.w.dx = (unsigned)path;
+	r.w.bx = (unsigned)&pb;
+	sr.es = sr.ds;
+	int86x(0x21, &r, &r, &sr);
+	if (r.w.cflag)
+		return -1;
+
+	r.h.ah = 0x4d;
+	int86(0x21, &r, &r);
+	return r.h.al;
+}
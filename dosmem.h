@@ -0,0 +1,14 @@
+#ifndef DOSMEM_H
+#define DOSMEM_H
+
+/* DOS memory and process helpers; sizes are in paragraphs. DOS 3 or later. */
+
+unsigned dos_psp(void);
+unsigned dos_block_size(void);
+unsigned dos_largest_free(void);
+unsigned dos_alloc(unsigned paras);
+void dos_free(unsigned seg);
+int dos_shrink(void);
+int dos_exec(const char *path, const char *args);
+
+#endif
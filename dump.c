@@ -0,0 +1,11 @@
+
+#include "dump.h"
+
+int dump_put(FILE *f, unsigned long v, int bytes) {
+	while (bytes--) {
+		if (putc(v & 0xff, f) == EOF)
+			return -1;
+		v >>= 8;
+	}
+	return 0;
+}
@@ -0,0 +1,12 @@
+#ifndef DUMP_H
+#define DUMP_H
+
+#include <stdio.h>
+
+/*
+ * Writes the low 'bytes' bytes of v to f, least significant first, as the
+ * region and trace dump formats store their fields; 0, or -1 on error.
+ */
+int dump_put(FILE *f, unsigned long v, int bytes);
+
+#endif
@@ -0,0 +1,83 @@
+
+#include <i86.h>
+
+#include "fario.h"
+
+/* One INT 21h/3Fh into seg:off; bytes read or -1 */
+static long dos_read(int fd, unsigned seg, unsigned off, unsigned n) {
+	union REGS r;
+	struct SREGS sr;
+
+	segread(&sr);
+	r.h.ah = 0x3f;
+	r.w.bx = fd;
+	r.w.cx = n;
+	r.w.dx = off;
+	sr.ds = seg;
+	int86x(0x21, &r, &r, &sr);
+	return r.w.cflag ? -1L : (long)r.w.ax;
+}
+
+static void far_copy(unsigned seg, unsigned off, const char *src, unsigned n) {
+	__asm__ volatile ("pushw %%es\n\t"
+			  "movw %3, %%es\n\t"
+			  "cld\n\t"
+			  "shrw $1, %%cx\n\t"
+			  "rep movsw\n\t"
+			  "adcw %%cx, %%cx\n\t"		/* the odd byte, if any */
+			  "rep movsb\n\t"
+			  "popw %%es"
+			  : "+D" (off), "+S" (src), "+c" (n)
+			  : "b" (seg)
+			  : "memory", "cc");
+}
+
+/*
+ * Both keep the destination normalised, with an offset below 16, so each
+ * read of up to FAR_CHUNK bytes stays within its segment.
+ */
+long far_read(int fd, void __far *dst, unsigned long n) {
+	unsigned seg = FP_SEG(dst) + (FP_OFF(dst) >> 4), off = FP_OFF(dst) & 15;
+	unsigned long done = 0;
+	unsigned chunk;
+	long got;
+
+	while (done < n) {
+		chunk = n - done > FAR_CHUNK ? FAR_CHUNK : n - done;
+		got = dos_read(fd, seg, off, chunk);
+		if (got < 0)
+			return -1;
+		done += got;
+		off += got;
+		seg += off >> 4;
+		off &= 15;
+		if (got < chunk)
+			break;
+	}
+	return done;
+}
+
+long far_read_staged(int fd, void __far *dst, unsigned long n, char *stage, unsigned size) {
+	unsigned seg = FP_SEG(dst) + (FP_OFF(dst) >> 4), off = FP_OFF(dst) & 15;
+	unsigned long done = 0;
+	unsigned chunk, ds;
+	long got;
+
+	if (size > FAR_CHUNK)
+		size = FAR_CHUNK;
+	__asm__ ("movw %%ds, %0" : "=r" (ds));
+	while (done < n) {
+		chunk = n - done > size ? size : n - done;
+		got = dos_read(fd, ds, (unsigned)stage, chunk);
+		if (got < 0)
+			return -1;
+		far_copy(seg, off, stage, got);
+		done += got;
+		off += got;
+		seg += off >> 4;
+		off &= 15;
+		if (got < chunk)
+			break;
+	}
+	return done;
+}
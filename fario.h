@@ -0,0 +1,16 @@
+#ifndef FARIO_H
+#define FARIO_H
+
+/*
+ * File reads into far or huge (over 64 KiB) destinations by DOS handle.
+ * far_read() points INT 21h/3Fh straight at the destination, splitting
+ * the read so that no call crosses a segment; far_read_staged() reads
+ * through a near buffer and copies, for comparison. Both return the
+ * bytes read, short at end of file, or -1.
+ */
+#define FAR_CHUNK	0xfff0u
+
+long far_read(int fd, void __far *dst, unsigned long n);
+long far_read_staged(int fd, void __far *dst, unsigned long n, char *stage, unsigned size);
+
+#endif
@@ -0,0 +1,83 @@
+#!/usr/bin/python3
+
+import argparse
+import re
+
+import dis86
+from program import Program
+
+
+# libgcc helpers for 32-bit arithmetic the 8086 has no instructions for
+HELPERS = r'^__(u?divsi3|u?modsi3|mulsi3|ashlsi3|ashrsi3|lshrsi3|negsi2|u?cmpsi2|u?divdi3|u?moddi3|muldi3)$'
+
+COLUMNS = ('near', 'far', 'ind', 'helper', 'segov', 'string', 'int', 'branch', 'i386')
+
+
+def classify(prog, sym, insns, helpers):
+    """Histogram of instruction classes; segment overrides count on top of the class.
+    Direct calls, near or far, to a function matching 'helpers' count as helper calls."""
+    h = dict((c, 0) for c in COLUMNS)
+    for i in insns:
+        if i.segov:
+            h['segov'] += 1
+        if i.i386:
+            h['i386'] += 1
+        if i.kind in (dis86.K_CALL, dis86.K_CALLF):
+            callee = prog.target(sym, i.target) if i.kind == dis86.K_CALL else prog.far_target(i)
+            if callee and helpers.match(callee.name):
+                h['helper'] += 1
+            else:
+                h['near' if i.kind == dis86.K_CALL else 'far'] += 1
+        elif i.kind == dis86.K_CALLI and i.ops[0].startswith('far'):
+            h['far'] += 1
+        elif i.kind == dis86.K_CALLI:
+            h['ind'] += 1
+        elif i.kind == dis86.K_STRING:
+            h['string'] += 1
+        elif i.kind == dis86.K_INT:
+            h['int'] += 1
+        elif i.kind in (dis86.K_JCC, dis86.K_JMP, dis86.K_JMPI, dis86.K_JMPF):
+            h['branch'] += 1
+    return h
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Per-function code size and instruction class histogram.")
+    parser.add_argument('exe', nargs='?', default='test-std.exe')
+    parser.add_argument('map', nargs='?', default='test-std.map')
+    parser.add_argument('--helpers', default=HELPERS, metavar='REGEX', help="names of long-math helper functions")
+    parser.add_argument('--sort', choices=('size', 'name', 'addr', 'segov', 'helper'), default='size')
+    args = parser.parse_args()
+
+    prog = Program(args.exe, args.map)
+    helpers = re.compile(args.helpers)
+
+    rows = []
+    for f in prog.functions():
+        insns = prog.insns(f)
+        rows.append((f, len(insns), classify(prog, f, insns, helpers)))
+
+    if args.sort == 'size':
+        rows.sort(key=lambda r: -r[0].size)
+    elif args.sort == 'name':
+        rows.sort(key=lambda r: r[0].name)
+    elif args.sort == 'addr':
+        rows.sort(key=lambda r: r[0].lma)
+    elif args.sort in ('segov', 'helper'):
+        rows.sort(key=lambda r: -r[2][args.sort] / max(1, r[1]))
+
+    print("%-24s %6s %6s %s %7s %7s" % ("function", "bytes", "insns",
+          ' '.join("%6s" % c for c in COLUMNS), "segov%", "helper%"))
+    total = dict((c, 0) for c in COLUMNS)
+    nbytes = ninsns = 0
+    for f, n, h in rows:
+        print("%-24s %6u %6u %s %6.1f%% %6.1f%%" % (f.name, f.size, n,
+              ' '.join("%6u" % h[c] for c in COLUMNS),
+              100.0 * h['segov'] / max(1, n), 100.0 * h['helper'] / max(1, n)))
+        for c in COLUMNS:
+            total[c] += h[c]
+        nbytes += f.size
+        ninsns += n
+    print("%-24s %6u %6u %s %6.1f%% %6.1f%%" % ("total", nbytes, ninsns,
+          ' '.join("%6u" % total[c] for c in COLUMNS),
+          100.0 * total['segov'] / max(1, ninsns), 100.0 * total['helper'] / max(1, ninsns)))
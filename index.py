@@ -0,0 +1,231 @@
+#!/usr/bin/python3
+
+import argparse
+import hashlib
+import sqlite3
+from pathlib import Path
+from sys import exit
+
+import archives
+import chunks
+from mapfile import MapFile
+from mzexe import FIELDS, MZExe, NotMZ
+
+
+PSP_BYTES = 0x100
+
+SCHEMA = """
+CREATE TABLE IF NOT EXISTS artifacts (
+    id INTEGER PRIMARY KEY,
+    path TEXT UNIQUE NOT NULL,
+    sha256 TEXT NOT NULL,
+    size INTEGER NOT NULL,
+    mtime REAL NOT NULL,
+    %s,
+    load_bytes INTEGER NOT NULL,
+    footprint_min INTEGER NOT NULL,
+    footprint_max INTEGER NOT NULL
+);
+CREATE INDEX IF NOT EXISTS artifacts_sha256 ON artifacts (sha256);
+CREATE INDEX IF NOT EXISTS artifacts_min_alloc ON artifacts (min_alloc);
+CREATE INDEX IF NOT EXISTS artifacts_nrelocs ON artifacts (nrelocs);
+
+CREATE TABLE IF NOT EXISTS sections (
+    artifact INTEGER NOT NULL REFERENCES artifacts (id) ON DELETE CASCADE,
+    name TEXT NOT NULL,
+    addr INTEGER NOT NULL,
+    size INTEGER NOT NULL,
+    lma INTEGER NOT NULL
+);
+CREATE INDEX IF NOT EXISTS sections_artifact ON sections (artifact);
+
+CREATE TABLE IF NOT EXISTS chunks (
+    artifact INTEGER NOT NULL REFERENCES artifacts (id) ON DELETE CASCADE,
+    digest TEXT NOT NULL,
+    offset INTEGER NOT NULL,
+    size INTEGER NOT NULL
+);
+CREATE INDEX IF NOT EXISTS chunks_artifact ON chunks (artifact);
+CREATE INDEX IF NOT EXISTS chunks_digest ON chunks (digest);
+
+CREATE TABLE IF NOT EXISTS metrics (
+    artifact INTEGER NOT NULL REFERENCES artifacts (id) ON DELETE CASCADE,
+    name TEXT NOT NULL,
+    value REAL NOT NULL,
+    PRIMARY KEY (artifact, name)
+);
+""" % ',\n    '.join('%s INTEGER NOT NULL' % f for f, _ in FIELDS)
+
+QUERIES = {
+    'largest-min-alloc': ("Largest min-alloc",
+        "SELECT path, min_alloc * 16 AS min_alloc_bytes, footprint_min FROM artifacts "
+        "ORDER BY min_alloc DESC LIMIT 20"),
+    'largest-footprint': ("Largest minimum footprint (PSP + load module + min-alloc)",
+        "SELECT path, footprint_min, load_bytes FROM artifacts ORDER BY footprint_min DESC LIMIT 20"),
+    'max-alloc-all': ("Builds that ask for all memory (max-alloc FFFFh)",
+        "SELECT path, footprint_min FROM artifacts WHERE max_alloc = 65535 ORDER BY path"),
+    'relocs': ("Builds with relocations",
+        "SELECT path, nrelocs FROM artifacts WHERE nrelocs > 0 ORDER BY nrelocs DESC"),
+    'text': ("Largest .text",
+        "SELECT a.path, s.size FROM sections s JOIN artifacts a ON a.id = s.artifact "
+        "WHERE s.name = '.text' ORDER BY s.size DESC LIMIT 20"),
+    'duplicates': ("Byte-identical artifacts",
+        "SELECT sha256, COUNT(*) AS copies, GROUP_CONCAT(path, ' ') AS paths FROM artifacts "
+        "GROUP BY sha256 HAVING copies > 1 ORDER BY copies DESC"),
+    'metrics': ("Metrics",
+        "SELECT a.path, m.name, m.value FROM metrics m JOIN artifacts a ON a.id = m.artifact "
+        "ORDER BY a.path, m.name"),
+}
+
+
+def connect(db):
+    con = sqlite3.connect(db)
+    con.execute("PRAGMA foreign_keys = ON")
+    con.executescript(SCHEMA)
+    return con
+
+
+def exes(paths):
+    for p in paths:
+        p = Path(p)
+        if p.is_dir():
+            for f in sorted(p.rglob('*')):
+                if f.is_file() and (f.suffix.lower() == '.exe' or archives.is_archive(f)):
+                    yield f
+        else:
+            yield p
+
+
+def add_chunks(con, aid, data):
+    con.executemany("INSERT INTO chunks VALUES (?, ?, ?, ?)",
+                    [(aid, d, o, l) for d, o, l in chunks.chunk(data)])
+
+
+def record(con, path, data, st, mapname, sha=None):
+    """Replace the rows for one artifact; byte-identical copies reuse the first analysis.
+
+    data may be just the header and relocation table of an archive member,
+    with sha then naming the whole content; such rows get no chunks. A copy
+    prefers a row with chunks, and chunks complete data itself otherwise.
+    """
+    sha = sha or hashlib.sha256(data).hexdigest()
+    con.execute("DELETE FROM artifacts WHERE path = ?", (str(path),))
+    same = con.execute("SELECT id FROM artifacts WHERE sha256 = ? "
+                       "ORDER BY EXISTS (SELECT 1 FROM chunks WHERE artifact = id) DESC, id LIMIT 1",
+                       (sha,)).fetchone()
+
+    if same:
+        cols = ', '.join(f for f, _ in FIELDS) + ', load_bytes, footprint_min, footprint_max'
+        cur = con.execute("INSERT INTO artifacts (path, sha256, size, mtime, %s) "
+                          "SELECT ?, sha256, size, ?, %s FROM artifacts WHERE id = ?" % (cols, cols),
+                          (str(path), st.st_mtime, same[0]))
+        aid = cur.lastrowid
+        for table, cols in (('sections', 'name, addr, size, lma'), ('chunks', 'digest, offset, size')):
+            con.execute("INSERT INTO %s SELECT ?, %s FROM %s WHERE artifact = ?" % (table, cols, table),
+                        (aid, same[0]))
+        if len(data) == st.st_size and not con.execute("SELECT 1 FROM chunks WHERE artifact = ?",
+                                                        (aid,)).fetchone():
+            add_chunks(con, aid, data)
+        return aid, True
+
+    exe = MZExe(data, str(path))
+    hdr = dict((f, getattr(exe, f)) for f, _ in FIELDS)
+    footprint = PSP_BYTES + exe.load_bytes
+    row = dict(hdr, path=str(path), sha256=sha,
+               size=st.st_size, mtime=st.st_mtime, load_bytes=exe.load_bytes,
+               footprint_min=footprint + exe.min_alloc * 16,
+               footprint_max=footprint + exe.max_alloc * 16)
+
+    cols = ', '.join(row)
+    cur = con.execute("INSERT INTO artifacts (%s) VALUES (%s)" % (cols, ', '.join('?' * len(row))),
+                      list(row.values()))
+    aid = cur.lastrowid
+    if mapname is not None and mapname.exists():
+        m = MapFile(mapname)
+        con.executemany("INSERT INTO sections VALUES (?, ?, ?, ?, ?)",
+                        [(aid, s.name, s.addr, s.size, s.lma) for s in m.sections])
+    if len(data) == st.st_size:
+        add_chunks(con, aid, data)
+    return aid, False
+
+
+def scan(con, paths, force, full=False):
+    added = skipped = dups = bad = 0
+
+    def known(path, st):
+        row = con.execute("SELECT size, mtime FROM artifacts WHERE path = ?", (str(path),)).fetchone()
+        return row and not force and row[0] == st.st_size and row[1] == st.st_mtime
+
+    for f in exes(paths):
+        if archives.is_archive(f):
+            items = ((m.path, m.data, m.stat, None, m.sha) for m in archives.members(f, known, full))
+        elif known(f, f.stat()):
+            items = [(f, None, None, None, None)]
+        else:
+            items = [(f, f.read_bytes(), f.stat(), f.with_suffix('.map'), None)]
+        for path, data, st, mapname, sha in items:
+            if data is None:
+                skipped += 1
+                continue
+            try:
+                _, dup = record(con, path, data, st, mapname, sha)
+                added += 1
+                dups += dup
+            except NotMZ as e:
+                print(e)
+                bad += 1
+    con.commit()
+    print("%u indexed (%u copies of known content), %u unchanged, %u not MZ" % (added, dups, skipped, bad))
+
+
+def show(con, title, sql, params=()):
+    cur = con.execute(sql, params)
+    names = [d[0] for d in cur.description]
+    rows = cur.fetchall()
+    if title:
+        print("%s:" % title)
+    widths = [max([len(n)] + [len(str(r[i])) for r in rows]) for i, n in enumerate(names)]
+    print(('  ' + '  '.join(n.ljust(w) for n, w in zip(names, widths))).rstrip())
+    for r in rows:
+        print(('  ' + '  '.join(str(v).ljust(w) for v, w in zip(r, widths))).rstrip())
+
+
+def set_metrics(con, path, pairs):
+    row = con.execute("SELECT id FROM artifacts WHERE path = ?", (str(Path(path)),)).fetchone()
+    if not row:
+        print("%s: not indexed" % path)
+        exit(1)
+    for p in pairs:
+        name, _, value = p.partition('=')
+        con.execute("INSERT OR REPLACE INTO metrics VALUES (?, ?, ?)", (row[0], name, float(value)))
+    con.commit()
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="SQLite index of MZ headers, map sections and run metrics.")
+    parser.add_argument('db', help="database file")
+    sub = parser.add_subparsers(dest='cmd', required=True)
+    p = sub.add_parser('scan', help="index EXEs (and their .map files) under the given paths, "
+                                    "including EXEs inside zip and tar archives")
+    p.add_argument('paths', nargs='+')
+    p.add_argument('--force', action='store_true', help="re-read unchanged files")
+    p.add_argument('--full', action='store_true',
+                   help="read whole archive members, for sha256 identity and chunks")
+    p = sub.add_parser('query', help="run a canned query")
+    p.add_argument('name', choices=sorted(QUERIES))
+    p = sub.add_parser('sql', help="run an SQL statement")
+    p.add_argument('statement')
+    p = sub.add_parser('metric', help="attach run metrics to an indexed EXE")
+    p.add_argument('path')
+    p.add_argument('pairs', nargs='+', metavar='NAME=VALUE')
+    args = parser.parse_args()
+
+    con = connect(args.db)
+    if args.cmd == 'scan':
+        scan(con, args.paths, args.force, args.full)
+    elif args.cmd == 'query':
+        show(con, *QUERIES[args.name])
+    elif args.cmd == 'sql':
+        show(con, None, args.statement)
+    else:
+        set_metrics(con, args.path, args.pairs)
@@ -0,0 +1,71 @@
+
+#include "kernels.h"
+
+/*
+ * Real-mode 386 kernels. The 66h operand-size prefix turns REP MOVSW/STOSW
+ * into REP MOVSD/STOSD; the count stays in CX as addressing is 16-bit. The
+ * bytes are emitted directly so that the assembler's -march does not matter.
+ * Only called once cpu_detect() has reported a 386 or later.
+ */
+
+void buf_fill_386(char *dst, char val, unsigned n) {
+	unsigned v = (unsigned char)val;
+
+	__asm__ volatile ("pushw %%es\n\t"
+			  "pushw %%ds\n\t"
+			  "popw %%es\n\t"
+			  "cld\n\t"
+			  "movb %%al, %%ah\n\t"
+			  "pushw %%ax\n\t"
+			  "pushw %%ax\n\t"
+			  ".byte 0x66, 0x58\n\t"	/* popl %eax */
+			  "movw %%di, %%dx\n\t"		/* align DI to a dword */
+			  "negw %%dx\n\t"
+			  "andw $3, %%dx\n\t"
+			  "cmpw %%cx, %%dx\n\t"
+			  "jbe 1f\n\t"
+			  "movw %%cx, %%dx\n"
+			  "1:\n\t"
+			  "subw %%dx, %%cx\n\t"
+			  "xchgw %%dx, %%cx\n\t"
+			  "rep stosb\n\t"
+			  "movw %%dx, %%cx\n\t"
+			  "shrw $1, %%cx\n\t"
+			  "shrw $1, %%cx\n\t"
+			  ".byte 0x66, 0xf3, 0xab\n\t"	/* rep stosl */
+			  "movw %%dx, %%cx\n\t"
+			  "andw $3, %%cx\n\t"
+			  "rep stosb\n\t"
+			  "popw %%es"
+			  : "+D" (dst), "+c" (n), "+a" (v)
+			  :
+			  : "dx", "memory", "cc");
+}
+
+void buf_copy_386(char *dst, const char *src, unsigned n) {
+	__asm__ volatile ("pushw %%es\n\t"
+			  "pushw %%ds\n\t"
+			  "popw %%es\n\t"
+			  "cld\n\t"
+			  "movw %%di, %%dx\n\t"		/* align DI to a dword */
+			  "negw %%dx\n\t"
+			  "andw $3, %%dx\n\t"
+			  "cmpw %%cx, %%dx\n\t"
+			  "jbe 1f\n\t"
+			  "movw %%cx, %%dx\n"
+			  "1:\n\t"
+			  "subw %%dx, %%cx\n\t"
+			  "xchgw %%dx, %%cx\n\t"
+			  "rep movsb\n\t"
+			  "movw %%dx, %%cx\n\t"
+			  "shrw $1, %%cx\n\t"
+			  "shrw $1, %%cx\n\t"
+			  ".byte 0x66, 0xf3, 0xa5\n\t"	/* rep movsl */
+			  "movw %%dx, %%cx\n\t"
+			  "andw $3, %%cx\n\t"
+			  "rep movsb\n\t"
+			  "popw %%es"
+			  : "+D" (dst), "+S" (src), "+c" (n)
+			  :
+			  : "dx", "memory", "cc");
+}
@@ -0,0 +1,27 @@
+
+#include "cpu.h"
+#include "kernels.h"
+
+#define WORD_ENTRY(sfx)		{buf_fill_word, buf_copy_word, buf_sum_##sfx}
+
+/*
+ * Best implementation for each CPU level: word string instructions for
+ * fill and copy up to the 286, the checksum built with that level's -march
+ */
+static const struct kernels table[CPU_TYPES] = {
+	WORD_ENTRY(8086),
+	WORD_ENTRY(186),
+	WORD_ENTRY(286),
+	{buf_fill_386, buf_copy_386, buf_sum_286},
+};
+
+struct kernels kern = WORD_ENTRY(8086);
+
+void kernels_init(int cpu) {
+	if (cpu >= 0 && cpu < CPU_TYPES)
+		kern = table[cpu];
+}
+
+const struct kernels *kernels_for(int cpu) {
+	return cpu >= 0 && cpu < CPU_TYPES ? &table[cpu] : 0;
+}
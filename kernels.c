@@ -0,0 +1,20 @@
+
+#include "kernels.h"
+
+void KNAME(buf_fill)(char *dst, char val, unsigned n) {
+	while (n--)
+		*dst++ = val;
+}
+
+void KNAME(buf_copy)(char *dst, const char *src, unsigned n) {
+	while (n--)
+		*dst++ = *src++;
+}
+
+unsigned KNAME(buf_sum)(const char *src, unsigned n) {
+	unsigned sum = 0;
+
+	while (n--)
+		sum += (unsigned char)*src++;
+	return sum;
+}
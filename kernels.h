@@ -0,0 +1,46 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+/*
+ * kernels.c is built once per dispatch level with KSUFFIX set to the level,
+ * giving buf_fill_8086, buf_fill_186 and so on. Without KSUFFIX the plain
+ * names are used, which is what the listings compared by cmpvar.py contain.
+ */
+#ifdef KSUFFIX
+#define KNAME(name)		KPASTE(name, KSUFFIX)
+#define KPASTE(name, sfx)	KPASTE2(name, sfx)
+#define KPASTE2(name, sfx)	name##_##sfx
+#else
+#define KNAME(name)		name
+#endif
+
+#define KERNEL_DECLARE(sfx) \
+	void buf_fill_##sfx(char *dst, char val, unsigned n); \
+	void buf_copy_##sfx(char *dst, const char *src, unsigned n); \
+	unsigned buf_sum_##sfx(const char *src, unsigned n);
+
+KERNEL_DECLARE(8086)
+KERNEL_DECLARE(186)
+KERNEL_DECLARE(286)
+
+/* REP STOSW/MOVSW versions in kword.c, used below the 386 */
+void buf_fill_word(char *dst, char val, unsigned n);
+void buf_copy_word(char *dst, const char *src, unsigned n);
+
+/* 32-bit string instruction versions in k386.c; the checksum is unchanged */
+void buf_fill_386(char *dst, char val, unsigned n);
+void buf_copy_386(char *dst, const char *src, unsigned n);
+
+struct kernels {
+	void (*fill)(char *dst, char val, unsigned n);
+	void (*copy)(char *dst, const char *src, unsigned n);
+	unsigned (*sum)(const char *src, unsigned n);
+};
+
+/* Implementations picked by kernels_init() for the running CPU */
+extern struct kernels kern;
+
+void kernels_init(int cpu);
+const struct kernels *kernels_for(int cpu);
+
+#endif
@@ -0,0 +1,56 @@
+
+#include "kernels.h"
+
+/*
+ * REP STOSW/MOVSW kernels, for every level below the 386. DI is brought
+ * to a word boundary first, which matters on the 8086, 186 and 286 with
+ * their 16-bit buses; the 8088 and 188 gain from fetching half as many
+ * string steps.
+ */
+
+void buf_fill_word(char *dst, char val, unsigned n) {
+	unsigned v = (unsigned char)val;
+
+	__asm__ volatile ("pushw %%es\n\t"
+			  "pushw %%ds\n\t"
+			  "popw %%es\n\t"
+			  "cld\n\t"
+			  "movb %%al, %%ah\n\t"
+			  "jcxz 1f\n\t"
+			  "testw $1, %%di\n\t"		/* align DI to a word */
+			  "jz 1f\n\t"
+			  "stosb\n\t"
+			  "decw %%cx\n"
+			  "1:\n\t"
+			  "shrw $1, %%cx\n\t"
+			  "rep stosw\n\t"
+			  "jnc 2f\n\t"			/* the odd byte, if any */
+			  "stosb\n"
+			  "2:\n\t"
+			  "popw %%es"
+			  : "+D" (dst), "+c" (n), "+a" (v)
+			  :
+			  : "memory", "cc");
+}
+
+void buf_copy_word(char *dst, const char *src, unsigned n) {
+	__asm__ volatile ("pushw %%es\n\t"
+			  "pushw %%ds\n\t"
+			  "popw %%es\n\t"
+			  "cld\n\t"
+			  "jcxz 1f\n\t"
+			  "testw $1, %%di\n\t"		/* align DI to a word */
+			  "jz 1f\n\t"
+			  "movsb\n\t"
+			  "decw %%cx\n"
+			  "1:\n\t"
+			  "shrw $1, %%cx\n\t"
+			  "rep movsw\n\t"
+			  "jnc 2f\n\t"			/* the odd byte, if any */
+			  "movsb\n"
+			  "2:\n\t"
+			  "popw %%es"
+			  : "+D" (dst), "+S" (src), "+c" (n)
+			  :
+			  : "memory", "cc");
+}
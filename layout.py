@@ -0,0 +1,157 @@
+#!/usr/bin/python3
+
+import argparse
+from pathlib import Path
+from sys import exit
+
+from mapfile import MapFile
+from mzexe import MZExe
+from relocs import load_base
+
+
+PSP_BYTES = 0x100
+
+COLOURS = {
+    'psp': '#b0b0b0',
+    'code': '#6a9fd4',
+    'data': '#e3a857',
+    'bss': '#d4d46a',
+    'heap/stack': '#8fd48f',
+    'stack': '#4fae4f',
+    'free': '#f2f2f2',
+    'pad': '#ffffff',
+}
+
+
+class Region:
+    def __init__(self, kind, name, start, size):
+        self.kind = kind
+        self.name = name
+        self.start = start
+        self.size = size
+
+    @property
+    def end(self):
+        return self.start + self.size
+
+
+def split(kind, m, sect, start):
+    """Regions for the sized symbols of a section loaded at 'start', gaps as the section."""
+    out = []
+    pos = start
+    for s in sorted((s for s in m.symbols if s.section is sect and s.size), key=lambda s: s.addr):
+        at = start + s.addr - sect.addr
+        if at > pos:
+            out.append(Region(kind, sect.name, pos, at - pos))
+        out.append(Region(kind, s.name, at, s.size))
+        pos = at + s.size
+    if start + sect.size > pos:
+        out.append(Region(kind, sect.name, pos, start + sect.size - pos))
+    return out
+
+
+def layout(exe, m, stack=None):
+    """Regions of the loaded image, addressed from the start of the PSP."""
+    base = load_base(m, None) - PSP_BYTES
+    regions = [Region('psp', 'PSP', 0, PSP_BYTES)]
+
+    for s in m.sections:
+        if not s.size or 'bss' in s.name:
+            continue
+        if s.name == '.data':
+            regions += split('data', m, s, s.lma - base)
+        else:
+            regions.append(Region('code' if 'text' in s.name else 'data', s.name, s.lma - base, s.size))
+
+    # .bss follows .data in DGROUP; the group starts where .data is loaded
+    data = m.section('.data')
+    dgroup = (data.lma - base - data.addr) if data else PSP_BYTES + exe.load_bytes
+    bss = m.section('.bss')
+    if bss:
+        regions += split('bss', m, bss, dgroup + bss.addr)
+        heap = dgroup + bss.end
+    else:
+        heap = PSP_BYTES + exe.load_bytes
+
+    top = exe.ss * 16 + (exe.sp or 0x10000) + PSP_BYTES
+    if top > heap:
+        if stack and stack < top - heap:
+            regions.append(Region('heap/stack', 'heap', heap, top - heap - stack))
+            regions.append(Region('stack', 'stack', top - stack, stack))
+        else:
+            regions.append(Region('heap/stack', 'heap/stack', heap, top - heap))
+
+    end_min = PSP_BYTES + exe.load_bytes + exe.min_alloc * 16
+    if end_min > top:
+        regions.append(Region('free', 'unused min-alloc', top, end_min - top))
+    if exe.max_alloc == 0xffff:
+        regions.append(Region('free', 'free (all memory)', max(top, end_min), 0))
+    else:
+        end_max = PSP_BYTES + exe.load_bytes + exe.max_alloc * 16
+        if end_max > max(top, end_min):
+            regions.append(Region('free', 'free to max-alloc', max(top, end_min), end_max - max(top, end_min)))
+
+    regions.sort(key=lambda r: (r.start, -r.size))
+    out = []
+    pos = 0
+    for r in regions:
+        if r.start > pos:
+            out.append(Region('pad', '', pos, r.start - pos))
+        out.append(r)
+        pos = max(pos, r.end)
+    return out
+
+
+def text(name, regions):
+    print("%s:" % name)
+    print("  %-20s %-10s %-8s %8s" % ("region", "start", "end", "bytes"))
+    for r in regions:
+        if r.kind == 'pad' and r.size < 16:
+            continue
+        print("  %-20s %04x:%04x  %05x %8s" % (r.name or '(gap)', r.start >> 4, r.start & 15, r.end,
+                                            '%u' % r.size if r.size else '-'))
+    print()
+
+
+def svg(columns, path):
+    width, height, top = 220, 640, 40
+    span = max(max(r.end for r in regs) for _, regs in columns) or 1
+    scale = float(height) / span
+    out = ['<svg xmlns="http://www.w3.org/2000/svg" width="%u" height="%u" font-family="monospace" font-size="10">'
+           % (width * len(columns), height + top + 20)]
+    for col, (name, regs) in enumerate(columns):
+        x = col * width + 10
+        out.append('<text x="%u" y="20" font-size="12">%s</text>' % (x, name))
+        for r in regs:
+            if r.kind == 'pad':
+                continue
+            y = top + r.start * scale
+            h = max(1.0, (r.size or 0x400) * scale)
+            out.append('<rect x="%u" y="%.1f" width="90" height="%.1f" fill="%s" stroke="#404040" stroke-width="0.5"/>'
+                       % (x, y, h, COLOURS[r.kind]))
+            if h >= 9:
+                out.append('<text x="%u" y="%.1f">%s %s</text>'
+                           % (x + 96, y + min(h, 18) / 2 + 4, r.name, '%u' % r.size if r.size else ''))
+    out.append('</svg>')
+    Path(path).write_text('\n'.join(out) + '\n')
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Memory layout of loaded MZ images, as text or SVG.")
+    parser.add_argument('exes', nargs='*', default=['test-std.exe'], metavar='EXE[:MAP]')
+    parser.add_argument('--svg', metavar='FILE', help="also draw the images side by side")
+    parser.add_argument('--stack', type=int, metavar='BYTES', help="split heap and stack, e.g. from stackdepth.py")
+    args = parser.parse_args()
+
+    columns = []
+    for spec in args.exes:
+        exename, _, mapname = spec.partition(':')
+        mapname = mapname or str(Path(exename).with_suffix('.map'))
+        if not Path(mapname).exists():
+            print("%s: no map file %s" % (exename, mapname))
+            exit(1)
+        regs = layout(MZExe.load(exename), MapFile(mapname), args.stack)
+        text(exename, regs)
+        columns.append((Path(exename).name, regs))
+    if args.svg:
+        svg(columns, args.svg)
@@ -0,0 +1,159 @@
+#!/usr/bin/python3
+
+import re
+from pathlib import Path
+
+
+_HEX = r'0x[0-9a-fA-F]+'
+_SECTION = re.compile(r'^(\S+)(?:\s+(%s)\s+(%s))?(?:\s+load address\s+(%s))?\s*$' % (_HEX, _HEX, _HEX))
+_INPUT = re.compile(r'^ (\S+)(?:\s+(%s)\s+(%s)\s+(.*))?$' % (_HEX, _HEX))
+_CONT = re.compile(r'^\s+(%s)\s+(%s)(?:\s+(.*))?$' % (_HEX, _HEX))
+_SYMBOL = re.compile(r'^\s+(%s)\s+([A-Za-z_.$][\w.$]*)\s*$' % _HEX)
+
+
+class Section:
+    def __init__(self, name, addr, size, lma=None, source=None):
+        self.name = name
+        self.addr = addr
+        self.size = size
+        self.lma = addr if lma is None else lma
+        self.source = source
+
+    @property
+    def end(self):
+        return self.addr + self.size
+
+
+class Symbol:
+    def __init__(self, name, addr, section, inp):
+        self.name = name
+        self.addr = addr
+        self.section = section
+        self.input = inp
+        self.size = 0
+
+    @property
+    def end(self):
+        return self.addr + self.size
+
+    @property
+    def lma(self):
+        return self.section.lma + (self.addr - self.section.addr)
+
+
+class MapFile:
+    """Output sections, input sections and symbols of a GNU ld map file."""
+
+    def __init__(self, path):
+        self.path = Path(path)
+        self.sections = []
+        self.inputs = []
+        self.symbols = []
+        self._parse(self.path.read_text().splitlines())
+        self._size_symbols()
+
+    def _parse(self, lines):
+        in_map = False
+        pending = None
+        sect = inp = None
+
+        for line in lines:
+            if not in_map:
+                in_map = line.startswith('Linker script and memory map')
+                continue
+            if not line.strip():
+                continue
+
+            # Long section names push address and size onto the next line
+            if pending is not None:
+                m = _CONT.match(line)
+                kind, name = pending
+                pending = None
+                if m:
+                    addr, size = int(m.group(1), 16), int(m.group(2), 16)
+                    if kind == 'out':
+                        lma = re.search(r'load address\s+(%s)' % _HEX, m.group(3) or '')
+                        sect = Section(name, addr, size, int(lma.group(1), 16) if lma else None)
+                        self.sections.append(sect)
+                        inp = None
+                    else:
+                        inp = Section(name, addr, size, source=(m.group(3) or '').strip())
+                        self.inputs.append(inp)
+                    continue
+
+            if not line[0].isspace():
+                m = _SECTION.match(line)
+                if not m or line.startswith(('LOAD', 'OUTPUT', 'START GROUP', 'END GROUP')):
+                    sect = inp = None
+                    continue
+                if m.group(2) is None:
+                    pending = ('out', m.group(1))
+                    continue
+                sect = Section(m.group(1), int(m.group(2), 16), int(m.group(3), 16),
+                               int(m.group(4), 16) if m.group(4) else None)
+                self.sections.append(sect)
+                inp = None
+                continue
+
+            m = _SYMBOL.match(line)
+            if m:
+                if sect is not None:
+                    self.symbols.append(Symbol(m.group(2), int(m.group(1), 16), sect, inp))
+                continue
+
+            m = _INPUT.match(line)
+            if m and not m.group(1).startswith('*') and sect is not None:
+                if m.group(2) is None:
+                    pending = ('in', m.group(1))
+                    continue
+                inp = Section(m.group(1), int(m.group(2), 16), int(m.group(3), 16),
+                              source=m.group(4).strip())
+                self.inputs.append(inp)
+
+    def _size_symbols(self):
+        # A symbol extends to the next symbol or the end of its input section
+        self.symbols.sort(key=lambda s: (s.section.name, s.addr))
+        for i, sym in enumerate(self.symbols):
+            limit = sym.input.end if sym.input else sym.section.end
+            nxt = self.symbols[i + 1] if i + 1 < len(self.symbols) else None
+            if nxt and nxt.section is sym.section and nxt.addr < limit:
+                limit = nxt.addr
+            sym.size = max(0, limit - sym.addr)
+
+    def section(self, name):
+        for s in self.sections:
+            if s.name == name:
+                return s
+        return None
+
+    def section_size(self, name):
+        s = self.section(name)
+        return s.size if s else 0
+
+    def symbol(self, name):
+        for s in self.symbols:
+            if s.name == name:
+                return s
+        return None
+
+    def symbol_at(self, addr, section='.text'):
+        for s in self.symbols:
+            if s.section.name == section and s.addr <= addr < s.end:
+                return s
+        return None
+
+    def section_at_lma(self, lma):
+        for s in self.sections:
+            if s.size and 'bss' not in s.name and s.lma <= lma < s.lma + s.size:
+                return s
+        return None
+
+    def symbol_at_lma(self, lma):
+        """Symbol covering a load address, for images with several code segments."""
+        for s in self.symbols:
+            if s.size and 'bss' not in s.section.name and s.lma <= lma < s.lma + s.size:
+                return s
+        return None
+
+    def functions(self, section='.text'):
+        return [s for s in self.symbols if s.section.name == section and s.size]
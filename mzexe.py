@@ -0,0 +1,75 @@
+#!/usr/bin/python3
+
+from pathlib import Path
+
+
+FIELDS = (
+    ('last_page', "Bytes in last page"),
+    ('pages', "Number of pages (inc last)"),
+    ('nrelocs', "Number of relocation entries"),
+    ('hdr_paras', "Header size (paragraphs)"),
+    ('min_alloc', "Min. Memory allocated (paragraphs)"),
+    ('max_alloc', "Max. Memory allocated (paragraphs)"),
+    ('ss', "Initial Stack Segment"),
+    ('sp', "Initial Stack Pointer"),
+    ('checksum', "Checksum (0 for none)"),
+    ('ip', "Initial Instruction Pointer"),
+    ('cs', "Initial Code Segment"),
+    ('reloc_ofs', "Offset of relocation table"),
+    ('overlay', "Overlay number"),
+)
+
+HEADER_SIZE = 2 + 2 * len(FIELDS)
+
+
+class NotMZ(Exception):
+    pass
+
+
+class MZExe:
+    """Decoded MZ header plus the load module it describes."""
+
+    def __init__(self, data, name='<exe>'):
+        if len(data) < HEADER_SIZE or data[0] != ord('M') or data[1] != ord('Z'):
+            raise NotMZ("%s: is not an EXE" % name)
+        self.name = name
+        self.data = data
+        for i, (field, _) in enumerate(FIELDS):
+            setattr(self, field, int.from_bytes(data[2 + 2 * i:4 + 2 * i], "little"))
+
+    @classmethod
+    def load(cls, path):
+        return cls(Path(path).read_bytes(), str(path))
+
+    @property
+    def header_bytes(self):
+        return self.hdr_paras * 16
+
+    @property
+    def image_bytes(self):
+        """Size of the file image the header describes, header included."""
+        if self.last_page:
+            return (self.pages - 1) * 512 + self.last_page
+        return self.pages * 512
+
+    @property
+    def load_bytes(self):
+        """Bytes DOS reads into memory at load time."""
+        return max(0, self.image_bytes - self.header_bytes)
+
+    @property
+    def load_module(self):
+        return self.data[self.header_bytes:self.image_bytes]
+
+    def relocations(self):
+        """(offset, segment) pairs from the relocation table."""
+        relocs = []
+        for i in range(self.nrelocs):
+            p = self.reloc_ofs + 4 * i
+            relocs.append((int.from_bytes(self.data[p:p + 2], "little"),
+                           int.from_bytes(self.data[p + 2:p + 4], "little")))
+        return relocs
+
+    def segment(self, seg):
+        """Load module bytes from paragraph 'seg' (relative to the load address) on."""
+        return self.load_module[seg * 16:]
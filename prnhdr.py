@@ -1,30 +1,86 @@
 #!/usr/bin/python3
 
+import argparse
 from pathlib import Path
 from sys import exit
 
+from dis86 import CPUS, disassemble
+from mzexe import FIELDS, MZExe, NotMZ
+from program import Program
 
-def dump_hdr(f):
-    b = f.read_bytes()
 
-    if b[0] != ord('M') or b[1] != ord('Z'):
+def dump_hdr(f):
+    try:
+        exe = MZExe.load(f)
+    except NotMZ:
         print("%s: is not an EXE" % str(f))
         exit(1)
 
     print("%s: MZ header OK!" % str(f))
-    print("  Bytes in last page:                 0x%04x" % int.from_bytes(b[2:4], "little"))
-    print("  Number of pages (inc last):         0x%04x" % int.from_bytes(b[4:6], "little"))
-    print("  Number of relocation entries:       0x%04x" % int.from_bytes(b[6:8], "little"))
-    print("  Header size (paragraphs):           0x%04x" % int.from_bytes(b[8:10], "little"))
-    print("  Min. Memory allocated (paragraphs): 0x%04x" % int.from_bytes(b[10:12], "little"))
-    print("  Max. Memory allocated (paragraphs): 0x%04x" % int.from_bytes(b[12:14], "little"))
-    print("  Initial Stack Segment:              0x%04x" % int.from_bytes(b[14:16], "little"))
-    print("  Initial Stack Pointer:              0x%04x" % int.from_bytes(b[16:18], "little"))
-    print("  Checksum (0 for none):              0x%04x" % int.from_bytes(b[18:20], "little"))
-    print("  Initial Instruction Pointer:        0x%04x" % int.from_bytes(b[20:22], "little"))
-    print("  Initial Code Segment:               0x%04x" % int.from_bytes(b[22:24], "little"))
-    print("  Offset of relocation table:         0x%04x" % int.from_bytes(b[24:26], "little"))
-    print("  Overlay number:                     0x%04x" % int.from_bytes(b[26:28], "little"))
+    for field, desc in FIELDS:
+        print("  %-36s0x%04x" % (desc + ':', getattr(exe, field)))
+
+
+def cycles(insn, cpu):
+    lo, hi = insn.cycles[cpu]
+    if lo is None:
+        return '-'
+    s = '%u' % lo if lo == hi else '%u-%u' % (lo, hi)
+    if insn.rep:
+        s += '+%un' % insn.rep[cpu] if insn.rep[cpu] is not None else ''
+    return s
+
+
+def dump_code(insns, seg, prog=None, sym=None):
+    """Print insns, labelled through prog relative to sym, a symbol in the same segment."""
+    print("  %-9s  %-17s  %-36s %8s %8s" % ("addr", "bytes", "", CPUS[0], CPUS[1]))
+    for i in insns:
+        if sym is not None:
+            s = prog.target(sym, i.addr)
+            if s and s.lma == sym.lma + i.addr - sym.addr:
+                print("%s:" % s.name)
+        text = i.text()
+        if i.target is not None and sym is not None:
+            text = text.replace('0x%04x' % i.target, prog.label(sym, i.target))
+        callee = prog.far_target(i) if prog else None
+        if callee:
+            text = text.replace('0x%04x:0x%04x' % i.far, callee.name)
+        print("  %04x:%04x  %-17s  %-36s %8s %8s" % (seg, i.addr, i.raw.hex(' '), text,
+                                                    cycles(i, CPUS[0]), cycles(i, CPUS[1])))
+    print("  %u instructions, %u bytes" % (len(insns), sum(i.size for i in insns)))
+
 
 if __name__ == '__main__':
-    dump_hdr(Path("test-std.exe"))
+    parser = argparse.ArgumentParser(description="Print an MZ header and disassemble its code.")
+    parser.add_argument('exe', nargs='?', default="test-std.exe")
+    parser.add_argument('-m', '--map', help="link map for symbolic labels and -f (default: EXE name with .map)")
+    parser.add_argument('-e', '--entry', action='store_true', help="disassemble from CS:IP")
+    parser.add_argument('-f', '--function', action='append', default=[], help="disassemble a function from the map")
+    parser.add_argument('-n', '--count', type=int, default=24, help="instructions shown from CS:IP (default 24)")
+    args = parser.parse_args()
+
+    dump_hdr(Path(args.exe))
+    if not (args.entry or args.function):
+        exit(0)
+
+    exe = MZExe.load(args.exe)
+    mapname = Path(args.map) if args.map else Path(args.exe).with_suffix('.map')
+    prog = Program(args.exe, mapname) if mapname.exists() else None
+
+    if args.entry:
+        # Decoded from CS:IP on, past the end of the entry function if need be
+        pos = exe.cs * 16 + exe.ip
+        sym = prog.map.symbol_at_lma(prog.base + pos) if prog else None
+        image = prog.image if prog else exe.load_module
+        print()
+        print("Entry point %04x:%04x%s" % (exe.cs, exe.ip, " (%s)" % prog.label(sym, exe.ip) if sym else ""))
+        dump_code(disassemble(image, pos, len(image), exe.ip - pos)[:args.count], exe.cs, prog, sym)
+
+    for name in args.function:
+        sym = prog.function(name) if prog else None
+        if sym is None:
+            print("%s: no such function in the map" % name)
+            exit(1)
+        print()
+        print("Function %s, %u bytes" % (name, sym.size))
+        dump_code(prog.insns(sym), (sym.lma - prog.base - sym.addr) >> 4, prog, sym)
@@ -0,0 +1,143 @@
+
+#include <conio.h>
+#include <i86.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dosmem.h"
+#include "prof.h"
+
+#define PIT_CH0		0x40
+#define PIT_CMD		0x43
+#define IRQ0_VECTOR	0x08
+
+/* Shared with the handler, which addresses them by name */
+volatile unsigned prof_pos, prof_end, prof_lost;
+volatile unsigned prof_div, prof_acc;
+
+static unsigned prof_base, prof_rate;
+static void __far *__far *const ivt = MK_FP(0, 0);
+
+/* Kept in the code segment, just before the handler */
+struct isr_data {
+	void __far *old;
+	unsigned ds;
+};
+
+/*
+ * The handler is assembled inside this function so that it shares the
+ * function's code segment in every memory model; the function itself only
+ * returns the far address of the data in front of it.
+ *
+ * Each tick stores the interrupted IP and CS while there is room, then adds
+ * the PIT divisor to a 16-bit accumulator. A carry means another 65536
+ * counts, a full BIOS tick, have passed, and the old handler is chained to
+ * (it sends the EOI); otherwise the EOI is sent here.
+ */
+static __attribute__((noinline)) struct isr_data __far *isr_data(void) {
+	unsigned ofs, seg;
+
+	__asm__ volatile ("jmp 9f\n"
+			  "prof_old:\n\t"
+			  ".long 0\n"
+			  "prof_ds:\n\t"
+			  ".word 0\n"
+			  "prof_isr:\n\t"
+			  "pushw %%bp\n\t"
+			  "movw %%sp, %%bp\n\t"
+			  "pushw %%ax\n\t"
+			  "pushw %%bx\n\t"
+			  "pushw %%ds\n\t"
+			  "movw %%cs:prof_ds, %%ds\n\t"
+			  "movw prof_pos, %%bx\n\t"
+			  "cmpw prof_end, %%bx\n\t"
+			  "jae 1f\n\t"
+			  "movw 2(%%bp), %%ax\n\t"	/* IP */
+			  "movw %%ax, (%%bx)\n\t"
+			  "movw 4(%%bp), %%ax\n\t"	/* CS */
+			  "movw %%ax, 2(%%bx)\n\t"
+			  "addw $4, %%bx\n\t"
+			  "movw %%bx, prof_pos\n\t"
+			  "jmp 2f\n"
+			  "1:\n\t"
+			  "incw prof_lost\n"
+			  "2:\n\t"
+			  "movw prof_div, %%ax\n\t"
+			  "addw %%ax, prof_acc\n\t"
+			  "popw %%ds\n\t"		/* pops leave CF alone */
+			  "popw %%bx\n\t"
+			  "popw %%ax\n\t"
+			  "popw %%bp\n\t"
+			  "jc 3f\n\t"
+			  "pushw %%ax\n\t"
+			  "movb $0x20, %%al\n\t"
+			  "outb %%al, $0x20\n\t"
+			  "popw %%ax\n\t"
+			  "iret\n"
+			  "3:\n\t"
+			  "ljmp *%%cs:prof_old\n"
+			  "9:\n\t"
+			  "movw $prof_old, %0\n\t"
+			  "movw %%cs, %1"
+			  : "=r" (ofs), "=r" (seg));
+	return MK_FP(seg, ofs);
+}
+
+void prof_start(void *buf, unsigned size, unsigned rate) {
+	struct isr_data __far *d = isr_data();
+	unsigned ds;
+
+	if (rate < 2)
+		rate = 2;
+	__asm__ ("movw %%ds, %0" : "=r" (ds));
+	prof_base = prof_pos = (unsigned)buf;
+	prof_end = prof_base + (size & ~3u);
+	prof_lost = prof_acc = 0;
+	prof_div = 0x10000UL / rate;
+	prof_rate = rate;
+
+	_disable();
+	d->old = ivt[IRQ0_VECTOR];
+	d->ds = ds;
+	ivt[IRQ0_VECTOR] = d + 1;
+	outp(PIT_CMD, 0x34);
+	outp(PIT_CH0, prof_div & 0xff);
+	outp(PIT_CH0, prof_div >> 8);
+	_enable();
+}
+
+void prof_stop(void) {
+	struct isr_data __far *d = isr_data();
+
+	_disable();
+	outp(PIT_CMD, 0x36);
+	outp(PIT_CH0, 0);
+	outp(PIT_CH0, 0);
+	ivt[IRQ0_VECTOR] = d->old;
+	_enable();
+}
+
+unsigned prof_samples(void) {
+	return (prof_pos - prof_base) / 4;
+}
+
+unsigned prof_overflow(void) {
+	return prof_lost;
+}
+
+int prof_dump(const char *path) {
+	struct prof_header h;
+	FILE *f = fopen(path, "wb");
+	int ok;
+
+	if (!f)
+		return -1;
+	memcpy(h.magic, PROF_MAGIC, sizeof h.magic);
+	h.rate = prof_rate;
+	h.load_seg = dos_psp() + 0x10;
+	h.count = prof_samples();
+	h.lost = prof_lost;
+	ok = fwrite(&h, sizeof h, 1, f) == 1 &&
+	     fwrite((void *)prof_base, 4, h.count, f) == h.count;
+	return fclose(f) == 0 && ok ? 0 : -1;
+}
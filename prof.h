@@ -0,0 +1,28 @@
+#ifndef PROF_H
+#define PROF_H
+
+/*
+ * Statistical profiler: IRQ 0 is sped up to 'rate' times the BIOS rate of
+ * 18.2 Hz and each tick stores the interrupted CS:IP. timer_read() is not
+ * valid while the profiler runs. prof_stop() must be called before exit.
+ *
+ * prof_dump() writes a struct prof_header followed by 'count' (ip, cs)
+ * word pairs; profsym.py resolves them against the link map.
+ */
+#define PROF_MAGIC	"PRF1"
+
+struct prof_header {
+	char magic[4];
+	unsigned rate;
+	unsigned load_seg;	/* segment the load module starts at */
+	unsigned count;
+	unsigned lost;		/* ticks after the buffer filled up */
+};
+
+void prof_start(void *buf, unsigned size, unsigned rate);
+void prof_stop(void);
+unsigned prof_samples(void);
+unsigned prof_overflow(void);
+int prof_dump(const char *path);
+
+#endif
@@ -0,0 +1,68 @@
+#!/usr/bin/python3
+
+import argparse
+import struct
+from pathlib import Path
+from sys import exit
+
+from mapfile import MapFile
+from relocs import load_base
+
+
+MAGIC = b'PRF1'
+HEADER = struct.Struct('<4sHHHH')
+BIOS_HZ = 1193182.0 / 65536
+
+
+def read(path):
+    data = Path(path).read_bytes()
+    magic, rate, load_seg, count, lost = HEADER.unpack_from(data)
+    if magic != MAGIC:
+        print("%s: not a profile" % path)
+        exit(1)
+    samples = [struct.unpack_from('<HH', data, HEADER.size + 4 * i) for i in range(count)]
+    return rate, load_seg, samples, lost
+
+
+def resolve(m, base, load_seg, ip, cs):
+    """(symbol, offset) in the program, or (None, description) outside it."""
+    lma = (cs - load_seg) * 16 + ip + base
+    if cs >= load_seg:
+        s = m.symbol_at_lma(lma)
+        if s:
+            return s, lma - s.lma
+    if cs >= 0xa000:
+        return None, "[ROM %04x]" % cs
+    return None, "[%s %04x]" % ("program" if cs >= load_seg else "DOS/TSR", cs)
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Symbolize PROF.DAT samples against a link map.")
+    parser.add_argument('profile', nargs='?', default='PROF.DAT')
+    parser.add_argument('map', nargs='?', default='test-std.map')
+    parser.add_argument('--base', type=lambda v: int(v, 0), help="LMA of the load module (default from the map)")
+    parser.add_argument('-a', '--addresses', action='store_true', help="also break functions down by address")
+    args = parser.parse_args()
+
+    rate, load_seg, samples, lost = read(args.profile)
+    m = MapFile(args.map)
+    base = load_base(m, args.base)
+
+    funcs, addrs = {}, {}
+    for ip, cs in samples:
+        sym, off = resolve(m, base, load_seg, ip, cs)
+        name = sym.name if sym else off
+        funcs[name] = funcs.get(name, 0) + 1
+        if sym:
+            addrs[(name, off)] = addrs.get((name, off), 0) + 1
+
+    total = len(samples)
+    print("%u samples at %.0f Hz (%.2f s), load segment %04x, %u lost after the buffer filled"
+          % (total, rate * BIOS_HZ, total / (rate * BIOS_HZ), load_seg, lost))
+    print("%8s %6s  %s" % ("samples", "%", "function"))
+    for name, n in sorted(funcs.items(), key=lambda f: (-f[1], f[0])):
+        print("%8u %5.1f%%  %s" % (n, 100.0 * n / total, name))
+        if args.addresses:
+            for (f, off), c in sorted(addrs.items()):
+                if f == name:
+                    print("%8u %6s    +0x%x" % (c, '', off))
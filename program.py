@@ -0,0 +1,57 @@
+#!/usr/bin/python3
+
+from dis86 import disassemble
+from mapfile import MapFile
+from mzexe import MZExe
+from relocs import load_base
+
+
+class Program:
+    """An EXE and its link map: functions decoded from the load module.
+
+    Code is located through each symbol's load address, so functions in
+    every code segment of a medium model build decode from their own bytes;
+    instruction addresses stay segment offsets, as in the map.
+    """
+
+    def __init__(self, exe, mapname, base=None):
+        self.exe = MZExe.load(exe)
+        self.map = MapFile(mapname)
+        self.image = self.exe.load_module
+        self.base = load_base(self.map, base)
+
+    @staticmethod
+    def is_code(sym):
+        return 'text' in sym.section.name
+
+    def functions(self):
+        return [s for s in self.map.symbols if s.size and self.is_code(s)]
+
+    def function(self, name):
+        s = self.map.symbol(name)
+        return s if s and self.is_code(s) else None
+
+    def insns(self, sym):
+        start = sym.lma - self.base
+        end = min(start + sym.size, len(self.image))
+        return disassemble(self.image, start, end, sym.addr - start)
+
+    def target(self, sym, addr):
+        """Function at near address addr, in sym's code segment."""
+        return self.map.symbol_at_lma(sym.lma + addr - sym.addr)
+
+    def far_target(self, insn):
+        """Function a direct far call or jump goes to."""
+        if insn.far is None:
+            return None
+        seg, off = insn.far
+        return self.map.symbol_at_lma(self.base + seg * 16 + off)
+
+    def label(self, sym, addr):
+        s = self.target(sym, addr)
+        if s is None:
+            return '0x%04x' % addr
+        lma = sym.lma + addr - sym.addr
+        if lma == s.lma:
+            return s.name
+        return '%s+0x%x' % (s.name, lma - s.lma)
@@ -0,0 +1,38 @@
+
+#include <stdio.h>
+#include <string.h>
+
+#include "dump.h"
+#include "region.h"
+
+#ifdef REGION_TIMERS
+
+struct region regions[REGION_COUNT];
+
+static const char *const names[REGION_COUNT] = {
+#define REGION_NAME(id, name)	name,
+	REGION_LIST(REGION_NAME)
+#undef REGION_NAME
+};
+
+int region_dump(const char *path) {
+	FILE *f = fopen(path, "wb");
+	int i, err = 0;
+
+	if (!f)
+		return -1;
+	err |= fputs(REGION_MAGIC, f) == EOF;
+	err |= dump_put(f, REGION_COUNT, 2);
+	for (i = 0; i < REGION_COUNT; i++) {
+		const char *s = names[i];
+
+		err |= dump_put(f, regions[i].count, 4);
+		err |= dump_put(f, regions[i].total, 4);
+		err |= dump_put(f, strlen(s), 1);
+		err |= fputs(s, f) == EOF;
+	}
+	err |= fclose(f) != 0;
+	return err ? -1 : 0;
+}
+
+#endif
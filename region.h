@@ -0,0 +1,60 @@
+#ifndef REGION_H
+#define REGION_H
+
+/*
+ * Region timers: REGION_BEGIN(id) and REGION_END(id) count the passes
+ * through a region and add up the PIT counts spent in it. They only cost
+ * anything in builds with REGION_TIMERS defined; otherwise every macro
+ * here expands to nothing.
+ *
+ * The timer must be in mode 2 (REGIONS_INIT() sets it up). REGIONS_DUMP()
+ * writes the table for regview.py and restores the timer.
+ */
+
+/* Regions timed in this program: id, name in the dump */
+#define REGION_LIST(R) \
+	R(R_FILL, "fill") \
+	R(R_COPY, "copy") \
+	R(R_SUM, "sum")
+
+enum region_id {
+#define REGION_ENUM(id, name)	id,
+	REGION_LIST(REGION_ENUM)
+#undef REGION_ENUM
+	REGION_COUNT
+};
+
+#ifdef REGION_TIMERS
+
+#include "timer.h"
+
+/* Dump: "RGN1", region count (word), then per region the pass count and
+   PIT counts (dwords), name length (byte) and name */
+#define REGION_MAGIC	"RGN1"
+
+struct region {
+	unsigned long count;
+	unsigned long total;
+	unsigned long start;
+};
+
+extern struct region regions[REGION_COUNT];
+
+int region_dump(const char *path);
+
+#define REGION_BEGIN(id)	(regions[id].start = timer_read())
+#define REGION_END(id)		(regions[id].total += timer_read() - regions[id].start, \
+				 regions[id].count++)
+#define REGIONS_INIT()		timer_init()
+#define REGIONS_DUMP(path)	(region_dump(path), timer_done())
+
+#else
+
+#define REGION_BEGIN(id)	((void)0)
+#define REGION_END(id)		((void)0)
+#define REGIONS_INIT()		((void)0)
+#define REGIONS_DUMP(path)	((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,63 @@
+#!/usr/bin/python3
+
+import argparse
+import struct
+from pathlib import Path
+from sys import exit
+
+
+MAGIC = b'RGN1'
+TIMER_HZ = 1193182.0
+
+
+def read(path):
+    """{name: (count, pit_counts)} from one REGIONS.DAT."""
+    data = Path(path).read_bytes()
+    if data[:4] != MAGIC:
+        raise ValueError("%s: not a region dump" % path)
+    n, = struct.unpack_from('<H', data, 4)
+    pos = 6
+    out = {}
+    for _ in range(n):
+        count, total, length = struct.unpack_from('<LLB', data, pos)
+        pos += 9
+        out[data[pos:pos + length].decode('ascii', 'replace')] = (count, total)
+        pos += length
+    return out
+
+
+def us(counts):
+    return counts * 1e6 / TIMER_HZ
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Aggregate region timer dumps (REGIONS.DAT).")
+    parser.add_argument('dumps', nargs='+')
+    parser.add_argument('-p', '--per-dump', action='store_true', help="also list every dump on its own")
+    args = parser.parse_args()
+
+    dumps = []
+    for d in args.dumps:
+        try:
+            dumps.append((d, read(d)))
+        except ValueError as e:
+            print(e)
+    if not dumps:
+        exit(1)
+
+    names = []
+    for _, regs in dumps:
+        names += [n for n in regs if n not in names]
+
+    print("%-12s %5s %10s %14s %12s" % ("region", "dumps", "passes", "total us", "mean us"))
+    for name in names:
+        hits = [regs[name] for _, regs in dumps if name in regs]
+        count = sum(c for c, _ in hits)
+        total = sum(t for _, t in hits)
+        print("%-12s %5u %10u %14.0f %12s" % (name, len(hits), count, us(total),
+                                             "%.1f" % us(total / count) if count else '-'))
+        if args.per_dump:
+            for d, regs in dumps:
+                if name in regs:
+                    c, t = regs[name]
+                    print("  %-16s %10u %14.0f %12s" % (Path(d).name, c, us(t), "%.1f" % us(t / c) if c else '-'))
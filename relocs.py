@@ -0,0 +1,108 @@
+#!/usr/bin/python3
+
+import argparse
+from sys import exit
+
+import dis86
+from mapfile import MapFile
+from mzexe import MZExe
+
+
+def load_base(m, base):
+    """Load address (LMA) of the first byte of the load module."""
+    if base is not None:
+        return base
+    # Linker scripts that emit the MZ header themselves place it at LMA 0
+    for name in ('.msdos_mz_hdr', '.mz_hdr'):
+        s = m.section(name)
+        if s:
+            return s.lma + s.size
+    return 0
+
+
+class Attribution:
+    def __init__(self, exe, m, base):
+        self.exe = exe
+        self.m = m
+        self.base = base
+        self.image = exe.load_module
+
+    def word(self, pos):
+        return int.from_bytes(self.image[pos:pos + 2], "little")
+
+    def name_at(self, pos):
+        """Symbol name for a load module offset."""
+        s = self.m.symbol_at_lma(pos + self.base)
+        if s:
+            lma = pos + self.base
+            return s.name if s.lma == lma else '%s+0x%x' % (s.name, lma - s.lma)
+        sect = self.m.section_at_lma(pos + self.base)
+        return '%s+0x%x' % (sect.name, pos + self.base - sect.lma) if sect else '0x%05x' % pos
+
+    def segment_name(self, seg):
+        sect = self.m.section_at_lma(seg * 16 + self.base)
+        if sect and sect.lma == seg * 16 + self.base:
+            return 'seg %s' % sect.name
+        return 'seg 0x%04x' % seg
+
+    def attribute(self, off, seg):
+        """(containing symbol, instruction text or None, referenced symbol) for one fix-up."""
+        pos = seg * 16 + off
+        lma = pos + self.base
+        owner = self.m.symbol_at_lma(lma)
+        sect = self.m.section_at_lma(lma)
+        value = self.word(pos)
+
+        insn = None
+        if owner and sect and 'text' in sect.name:
+            start = owner.lma - self.base
+            for i in dis86.disassemble(self.image, start, start + owner.size, owner.addr - start):
+                ipos = i.addr - owner.addr + start
+                if ipos <= pos < ipos + i.size:
+                    insn = i
+                    break
+        if insn is not None and insn.far is not None:
+            ref = self.name_at(insn.far[0] * 16 + insn.far[1])
+        elif insn is None and pos >= 2:
+            # Far pointer in data: the offset word precedes the segment word
+            ref = self.name_at(value * 16 + self.word(pos - 2))
+        else:
+            ref = self.segment_name(value)
+        return owner, insn, ref
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Attribute MZ relocations to instructions and symbols.")
+    parser.add_argument('exe', nargs='?', default='test-med.exe')
+    parser.add_argument('map', nargs='?', default='test-med.map')
+    parser.add_argument('--base', type=lambda v: int(v, 0), metavar='LMA',
+                        help="load address of the load module start (default: after the header section, or 0)")
+    parser.add_argument('-v', '--verbose', action='store_true', help="list every relocation")
+    args = parser.parse_args()
+
+    exe = MZExe.load(args.exe)
+    m = MapFile(args.map)
+    a = Attribution(exe, m, load_base(m, args.base))
+
+    relocs = exe.relocations()
+    print("%s: %u relocation entries" % (args.exe, len(relocs)))
+    if not relocs:
+        exit(0)
+
+    by_func = {}
+    for off, seg in relocs:
+        owner, insn, ref = a.attribute(off, seg)
+        name = owner.name if owner else '(unknown)'
+        by_func.setdefault(name, []).append(ref)
+        if args.verbose:
+            print("  %04x:%04x  %-24s %-32s -> %s" % (seg, off, a.name_at(seg * 16 + off),
+                                                     insn.text() if insn else '(data)', ref))
+
+    print()
+    print("%-24s %6s  %s" % ("symbol", "relocs", "references"))
+    for name, refs in sorted(by_func.items(), key=lambda kv: -len(kv[1])):
+        counts = {}
+        for r in refs:
+            counts[r] = counts.get(r, 0) + 1
+        print("%-24s %6u  %s" % (name, len(refs), ', '.join(
+            '%s%s' % (r, ' x%u' % n if n > 1 else '') for r, n in sorted(counts.items()))))
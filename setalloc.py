@@ -0,0 +1,53 @@
+#!/usr/bin/python3
+
+import argparse
+from pathlib import Path
+from sys import exit
+
+from mzexe import FIELDS, MZExe, NotMZ
+
+
+def field_offset(name):
+    return 2 + 2 * [f for f, _ in FIELDS].index(name)
+
+
+def paragraphs(value, exe):
+    """'min' (the header's min-alloc), 'all' (FFFFh) or a number of paragraphs."""
+    if value == 'min':
+        return exe.min_alloc
+    if value == 'all':
+        return 0xffff
+    n = int(value, 16)
+    if not 0 <= n <= 0xffff:
+        raise ValueError("%s: out of range" % value)
+    return n
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Copy an EXE with different min-alloc/max-alloc header values.")
+    parser.add_argument('exe')
+    parser.add_argument('-o', '--output', required=True)
+    parser.add_argument('--max', metavar='PARAS', help="max-alloc: hex paragraphs, 'min' or 'all'")
+    parser.add_argument('--min', metavar='PARAS', help="min-alloc: hex paragraphs")
+    args = parser.parse_args()
+
+    data = bytearray(Path(args.exe).read_bytes())
+    try:
+        exe = MZExe(bytes(data), args.exe)
+    except NotMZ as e:
+        print(e)
+        exit(1)
+
+    for name, value in (('min_alloc', args.min), ('max_alloc', args.max)):
+        if value is None:
+            continue
+        n = paragraphs(value, exe)
+        if name == 'max_alloc' and n < (exe.min_alloc if args.min is None else paragraphs(args.min, exe)):
+            print("%s: max-alloc %04x is below min-alloc" % (args.exe, n))
+            exit(1)
+        off = field_offset(name)
+        data[off:off + 2] = n.to_bytes(2, "little")
+
+    Path(args.output).write_bytes(data)
+    new = MZExe(bytes(data), args.output)
+    print("%s: min-alloc %04x, max-alloc %04x" % (args.output, new.min_alloc, new.max_alloc))
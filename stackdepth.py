@@ -0,0 +1,193 @@
+#!/usr/bin/python3
+
+import argparse
+import re
+from pathlib import Path
+from sys import exit
+
+from mapfile import MapFile
+from mzexe import MZExe
+
+
+_FUNC = re.compile(r'^([A-Za-z_$][\w.$]*):')
+_GLOBAL = re.compile(r'^\t\.globa?l\s+([\w.$]+)')
+_CALL = re.compile(r'^\t(l?call)[lw]?\t(\*?)([^\s,]+)')
+
+
+def read_su(path, frames):
+    # file.c:12:5:name<TAB>bytes<TAB>static|dynamic[,bounded]
+    for line in Path(path).read_text().splitlines():
+        parts = line.split('\t')
+        if len(parts) < 3:
+            continue
+        name = parts[0].rsplit(':', 1)[-1]
+        frames[name] = (int(parts[1]), parts[2])
+
+
+def read_calls(path, calls, indirect, globs):
+    func = None
+    for line in Path(path).read_text().splitlines():
+        m = _GLOBAL.match(line)
+        if m:
+            globs.add(m.group(1))
+            continue
+        m = _FUNC.match(line)
+        if m:
+            func = m.group(1)
+            calls.setdefault(func, set())
+            continue
+        m = _CALL.match(line)
+        if m and func is not None:
+            if m.group(2):
+                indirect.add(func)
+            else:
+                calls[func].add(m.group(3).lstrip('$'))
+
+
+def read_ann(path, frames, calls, stacks):
+    """Frames for code without .su files ('name bytes'), extra edges ('caller -> callee ...')
+    and functions entered on a stack of their own ('stack name bytes')."""
+    for line in Path(path).read_text().splitlines():
+        line = line.split('#', 1)[0].strip()
+        if not line:
+            continue
+        if line.startswith('stack '):
+            _, name, size = line.split()
+            stacks[name] = int(size, 0)
+        elif '->' in line:
+            caller, callees = line.split('->', 1)
+            calls.setdefault(caller.strip(), set()).update(callees.split())
+        else:
+            name, size = line.split()
+            frames.setdefault(name, (int(size, 0), 'annotated'))
+
+
+class Analysis:
+    def __init__(self, frames, calls, ret_bytes, default):
+        self.frames = frames
+        self.calls = calls
+        self.ret_bytes = ret_bytes
+        self.default = default
+        self.unknown = set()
+        self.memo = {}
+
+    def frame(self, func):
+        if func in self.frames:
+            return self.frames[func][0]
+        self.unknown.add(func)
+        return self.default
+
+    def depth(self, func, active=()):
+        """Worst-case bytes used by a call to func, with the path that uses them."""
+        if func in self.memo:
+            return self.memo[func]
+        if func in active:
+            return None, list(active[active.index(func):]) + [func]
+        active = active + (func,)
+        worst, path = 0, []
+        for callee in sorted(self.calls.get(func, ())):
+            d, p = self.depth(callee, active)
+            if d is None:
+                return None, p
+            if d > worst:
+                worst, path = d, p
+        result = (self.ret_bytes + self.frame(func) + worst, [func] + path)
+        self.memo[func] = result
+        return result
+
+
+def reserved_stack(exe, m):
+    """Bytes between the end of .bss and the initial SP in the stack segment."""
+    bss = m.section('.bss')
+    sp = exe.sp or 0x10000
+    top = bss.end if bss else 0
+    return sp - top if sp > top else None
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Worst-case stack depth from -fstack-usage output and the call graph.")
+    parser.add_argument('files', nargs='+', help=".su files and gcc -S listings")
+    parser.add_argument('--map', help="link map, restricts the analysis to functions that were linked")
+    parser.add_argument('--exe', help="EXE whose header gives the reserved stack")
+    parser.add_argument('--ann', help="annotations: library frames and calls through pointers")
+    parser.add_argument('--entry', action='append', help="entry point (default: main and every uncalled function)")
+    parser.add_argument('--far', action='store_true', help="far calls (medium model), 4 byte return addresses")
+    parser.add_argument('--default', type=int, default=0, metavar='BYTES',
+                        help="frame assumed for functions with no stack information")
+    parser.add_argument('--margin', type=int, default=0, metavar='BYTES',
+                        help="headroom on each stack for interrupt handlers and DOS")
+    args = parser.parse_args()
+
+    frames, calls, indirect, globs, stacks = {}, {}, set(), set(), {}
+    for f in args.files:
+        if f.endswith('.su'):
+            read_su(f, frames)
+        else:
+            read_calls(f, calls, indirect, globs)
+    if args.ann:
+        read_ann(args.ann, frames, calls, stacks)
+
+    # A function entered on its own stack is not charged to the caller that switches to it
+    for c in calls.values():
+        c.difference_update(stacks)
+
+    # Static functions are not in the map; drop global ones the linker did not keep
+    m = MapFile(args.map) if args.map else None
+    if m:
+        linked = set(s.name for s in m.functions())
+        calls = dict((f, c) for f, c in calls.items() if f in linked or f not in globs)
+
+    called = set().union(*calls.values()) if calls else set()
+    entries = args.entry or ['main'] + sorted(f for f in calls if f not in called and f != 'main')
+
+    a = Analysis(frames, calls, 4 if args.far else 2, args.default)
+    worst = 0
+    print("Worst-case stack depth (bytes, including return addresses):")
+    for e in entries:
+        d, path = a.depth(e)
+        if d is None:
+            print("  %-20s unbounded, recursion: %s" % (e, ' -> '.join(path)))
+            if e not in stacks:
+                worst = None
+            continue
+        print("  %-20s %6u  %s" % (e, d, ' -> '.join(path)))
+        if worst is not None and e not in stacks:
+            worst = max(worst, d)
+
+    short = False
+    for e in sorted(stacks):
+        d = a.depth(e)[0]
+        print()
+        if d is None:
+            print("Stack of %s: %u bytes, worst case unbounded" % (e, stacks[e]))
+            short = True
+            continue
+        need = d + args.margin
+        print("Stack of %s: %u bytes, needed %u (%u + %u margin), %s %u bytes"
+              % (e, stacks[e], need, d, args.margin,
+                 "spare" if stacks[e] >= need else "SHORT by", abs(stacks[e] - need)))
+        short |= stacks[e] < need
+
+    if indirect:
+        print()
+        print("Calls through pointers, covered only by '->' annotations: %s" % ' '.join(sorted(indirect)))
+    if a.unknown:
+        print()
+        print("No stack information, %u bytes assumed: %s" % (args.default, ' '.join(sorted(a.unknown))))
+
+    if args.exe and m:
+        reserved = reserved_stack(MZExe.load(args.exe), m)
+        print()
+        if reserved is None:
+            print("Reserved stack: unknown, SP lies below the end of .bss")
+        elif worst is None:
+            print("Reserved stack: %u bytes, worst case unbounded" % reserved)
+        else:
+            need = worst + args.margin
+            print("Reserved stack: %u bytes, needed %u (%u + %u margin), %s %u bytes"
+                  % (reserved, need, worst, args.margin,
+                     "spare" if reserved >= need else "SHORT by", abs(reserved - need)))
+            if reserved < need:
+                exit(1)
+    if short:
+        exit(1)
@@ -0,0 +1,38 @@
+
+#include <unistd.h>
+
+#include "stream.h"
+
+long stream_copy(int in, int out, char *buf, unsigned size, stream_sum_fn fn, unsigned *sum) {
+	unsigned long done = 0;
+	int n;
+
+	while ((n = read(in, buf, size)) > 0) {
+		*sum += fn(buf, n);
+		if (write(out, buf, n) != n)
+			return -1;
+		done += n;
+	}
+	return n < 0 ? -1 : (long)done;
+}
+
+/*
+ * DOS calls block until they complete, so the read ahead runs before the
+ * stages on the other buffer rather than alongside them; the order is the
+ * one an asynchronous read would need.
+ */
+long stream_copy2(int in, int out, char *buf[2], const unsigned size[2], stream_sum_fn fn, unsigned *sum) {
+	unsigned long done = 0;
+	int n[2], cur = 0;
+
+	n[0] = read(in, buf[0], size[0]);
+	while (n[cur] > 0) {
+		n[cur ^ 1] = read(in, buf[cur ^ 1], size[cur ^ 1]);
+		*sum += fn(buf[cur], n[cur]);
+		if (write(out, buf[cur], n[cur]) != n[cur])
+			return -1;
+		done += n[cur];
+		cur ^= 1;
+	}
+	return n[cur] < 0 ? -1 : (long)done;
+}
@@ -0,0 +1,16 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+/*
+ * File to file copy that runs every chunk through a checksum stage.
+ * stream_copy() reads each buffer full, sums and writes it. stream_copy2()
+ * ping-pongs between two buffers: the next chunk is read into one while
+ * the other is summed and written. Both return the bytes copied, or -1,
+ * and add the chunk sums to *sum.
+ */
+typedef unsigned (*stream_sum_fn)(const char *src, unsigned n);
+
+long stream_copy(int in, int out, char *buf, unsigned size, stream_sum_fn fn, unsigned *sum);
+long stream_copy2(int in, int out, char *buf[2], const unsigned size[2], stream_sum_fn fn, unsigned *sum);
+
+#endif
@@ -1,12 +1,574 @@
 
+#include <fcntl.h>
+#include <i86.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "coro.h"
+#include "cpu.h"
+#include "dosmem.h"
+#include "fario.h"
+#include "kernels.h"
+#include "prof.h"
+#include "region.h"
+#include "stream.h"
+#include "timer.h"
+#include "trace.h"
+#include "uart.h"
+#include "video.h"
+
+#ifdef INTEGER_PRINTF
+/* newlib's integer-only printf leaves out the floating point formatting */
+#define printf iprintf
+#define sprintf siprintf
+#endif
+
+/* 32 x 18.2 Hz, about 580 samples a second */
+#define PROF_RATE	32
+#define PROF_PASSES	64
+
+/* Serial echo test against a host running uartpump.py */
+#define UART_BAUD	115200UL
+#define UART_BLOCK	1024
+#define UART_TIMEOUT	18	/* BIOS ticks, about a second */
+
+/* 'test child' exits with its memory block size in 4 KiB units */
+#define SPAWN_UNIT	256	/* paragraphs */
+
+/* Test file of several ubuf1s, so that reads into it cross segments */
+#define FARREAD_FILE	"FARREAD.TMP"
+#define FARREAD_COPIES	3
+
+#define STREAM_IN	"STREAM.IN"
+#define STREAM_OUT	"STREAM.OUT"
+#define STREAM_COPIES	4
 
 char ubuf1[0x7fff];
 char ubuf2[0x3fff];
 
+#ifdef EVENT_TRACE
+/* The trace ring takes the top of ubuf2; the rest is left to the kernels */
+#define TRACE_BYTES	0x800
+#else
+#define TRACE_BYTES	0
+#endif
+#define UBUF2_BYTES	(sizeof ubuf2 - TRACE_BYTES)
+
 char ibuf[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
 
-int main() {
+BENCH(fill) {
+	const struct kernels *k = kernels_for(arg);
+
+	while (iters--) {
+		TRACE(T_FILL, iters);
+		REGION_BEGIN(R_FILL);
+		k->fill(ubuf1, 0x5a, sizeof ubuf1);
+		REGION_END(R_FILL);
+		TRACE(T_FILL_END, iters);
+	}
+}
+
+BENCH(copy) {
+	const struct kernels *k = kernels_for(arg);
+
+	while (iters--) {
+		TRACE(T_COPY, iters);
+		REGION_BEGIN(R_COPY);
+		k->copy(ubuf2, ubuf1, UBUF2_BYTES);
+		REGION_END(R_COPY);
+		TRACE(T_COPY_END, iters);
+	}
+}
+
+/* Run for every kernel level the running CPU can execute */
+static const struct bench kernel_benches[] = {
+	BENCH_ENTRY(fill),
+	BENCH_ENTRY(copy),
+};
+
+/*
+ * The 286 level runs the REP STOSW/MOVSW kernels, so on a 386 the ratio of
+ * the two medians is the gain from REP STOSD/MOVSD.
+ */
+static void bench(int cpu) {
+	unsigned long med[CPU_TYPES][BENCH_COUNT(kernel_benches)], x;
+	int level;
+	unsigned i;
+
+	timer_init();
+	for (level = 0; level <= cpu; level++) {
+		TRACE(T_LEVEL, level);
+		for (i = 0; i < BENCH_COUNT(kernel_benches); i++)
+			med[level][i] = bench_run(&kernel_benches[i], level, cpu_name(level));
+	}
+	timer_done();
+
+	for (i = 0; cpu >= CPU_386 && i < BENCH_COUNT(kernel_benches); i++) {
+		x = med[CPU_386][i] ? med[CPU_286][i] * 100 / med[CPU_386][i] : 0;
+		printf("386:   %s x%lu.%02lu over the word kernels\n", kernel_benches[i].name, x / 100, x % 100);
+	}
+}
+
+/*
+ * Run every kernel level under the profiler. The samples go to ubuf2, so
+ * the workload copies within ubuf1.
+ */
+static void profile(int cpu) {
+	int level, i;
+
+	prof_start(ubuf2, UBUF2_BYTES, PROF_RATE);
+	for (level = 0; level <= cpu; level++) {
+		const struct kernels *k = kernels_for(level);
+
+		for (i = 0; i < PROF_PASSES; i++) {
+			k->fill(ubuf1, 0x5a, sizeof ubuf1);
+			k->copy(ubuf1 + sizeof ubuf1 / 2, ubuf1, sizeof ubuf1 / 2);
+			k->sum(ubuf1, sizeof ubuf1);
+		}
+	}
+	prof_stop();
+
+	if (prof_dump("PROF.DAT") != 0)
+		printf("Prof:  cannot write PROF.DAT\n");
+	else
+		printf("Prof:  %u samples, %u lost, written to PROF.DAT\n", prof_samples(), prof_overflow());
+}
+
+static unsigned char uart_tx_seq, uart_rx_seq;
+static unsigned uart_errors, uart_timeouts;
+
+/*
+ * Send UART_BLOCK bytes of a counting pattern and read back the echo,
+ * checking the sequence. A gap resynchronises on the byte received.
+ */
+BENCH(uart_echo) {
+	char blk[64];
+	unsigned sent, got, n, i, start;
+
+	while (iters--) {
+		sent = got = 0;
+		start = timer_read() >> 16;
+		while (got < UART_BLOCK) {
+			if (sent < UART_BLOCK) {
+				n = UART_BLOCK - sent < sizeof blk ? UART_BLOCK - sent : sizeof blk;
+				for (i = 0; i < n; i++)
+					blk[i] = uart_tx_seq + i;
+				n = uart_write(blk, n);
+				uart_tx_seq += n;
+				sent += n;
+			}
+			n = uart_read(blk, sizeof blk);
+			for (i = 0; i < n; i++) {
+				if ((unsigned char)blk[i] != uart_rx_seq) {
+					uart_errors++;
+					uart_rx_seq = blk[i];
+				}
+				uart_rx_seq++;
+			}
+			got += n;
+			if ((unsigned)((timer_read() >> 16) - start) > UART_TIMEOUT) {
+				uart_timeouts++;
+				return;
+			}
+		}
+	}
+}
+
+static const struct bench uart_benches[] = {
+	BENCH_ENTRY(uart_echo),
+};
+
+/*
+ * Echo through COM1 or COM2, receiving into ubuf1 and transmitting from
+ * ubuf2. The worst service latency follows from how far past the receive
+ * trigger level the FIFO had filled when the handler got to it.
+ */
+static void uart_bench(int com) {
+	struct uart_stats st;
+	unsigned long med;
+
+	if (uart_open(com == 2 ? COM2_BASE : COM1_BASE, com == 2 ? COM2_IRQ : COM1_IRQ, UART_BAUD,
+		      ubuf1, sizeof ubuf1, ubuf2, UBUF2_BYTES) != 0) {
+		printf("UART:  no COM%d\n", com);
+		return;
+	}
+	timer_init();
+	med = bench_run(&uart_benches[0], com, com == 2 ? "com2" : "com1");
+	timer_done();
+	uart_close();
+	uart_stats(&st);
+
+	printf("UART:  %s, %lu bytes/s each way at %lu baud\n",
+	       st.fifo > 1 ? "16550A FIFO" : "no FIFO",
+	       med ? UART_BLOCK * 1000000UL / med * 10 : 0, UART_BAUD);
+	printf("UART:  %u ints, max %u bytes per service, %u overruns, %u dropped, %u errors, %u timeouts\n",
+	       st.ints, st.max_burst, st.overrun, st.dropped, uart_errors, uart_timeouts);
+	if (st.fifo > 1 && st.max_burst > UART_TRIGGER)
+		printf("UART:  worst service latency ~%lu us (%u bytes past the trigger level)\n",
+		       (st.max_burst - UART_TRIGGER) * 10000000UL / UART_BAUD, st.max_burst - UART_TRIGGER);
+}
+
+static char con_line[64];
+static unsigned con_len;
+static int con_fd;
+
+/* The same line through DOS (INT 21h/40h to CON) and straight to video memory */
+BENCH(con_dos) {
+	while (iters--)
+		write(con_fd, con_line, con_len);
+}
+
+BENCH(con_video) {
+	while (iters--)
+		video_write(con_line, con_len);
+}
+
+static const struct bench con_benches[] = {
+	BENCH_ENTRY(con_dos),
+	BENCH_ENTRY(con_video),
+};
+
+/* CON rather than stdout, so that both paths reach the screen when the
+   results are redirected to a file */
+static void video_bench(void) {
+	unsigned i;
+
+	con_fd = open("CON", O_WRONLY);
+	if (con_fd < 0) {
+		printf("Video: cannot open CON\n");
+		return;
+	}
+	con_len = sprintf(con_line, "Sizes: ubuf1=%6u, ubuf2=%6u\r\n", sizeof ubuf1, sizeof ubuf2);
+	video_init();
+
+	timer_init();
+	for (i = 0; i < BENCH_COUNT(con_benches); i++)
+		bench_run(&con_benches[i], 0, "line");
+	timer_done();
+	close(con_fd);
+}
+
+static const char *spawn_path;
+static int spawn_status;
+
+BENCH(spawn) {
+	while (iters--)
+		spawn_status = dos_exec(spawn_path, "child");
+}
+
+static const struct bench spawn_benches[] = {
+	BENCH_ENTRY(spawn),
+};
+
+/*
+ * EXEC a child copy of this program until it exits, as a batch driver
+ * would. With 'shrink' our own block is first cut down to what we use,
+ * instead of what the header's max-alloc got us.
+ */
+static void spawn_bench(const char *self, int shrink) {
+	printf("Spawn: block=%u KiB, largest free=%u KiB\n", dos_block_size() / 64, dos_largest_free() / 64);
+	if (shrink) {
+		if (dos_shrink() != 0)
+			printf("Spawn: shrink refused\n");
+		printf("Spawn: shrunk block=%u KiB, largest free=%u KiB\n",
+		       dos_block_size() / 64, dos_largest_free() / 64);
+	}
+
+	spawn_path = self;
+	spawn_status = dos_exec(self, "child");
+	if (spawn_status < 0) {
+		printf("Spawn: cannot EXEC %s\n", self);
+		return;
+	}
+	printf("Spawn: child got %u KiB\n", spawn_status * (SPAWN_UNIT / 64));
+
+	timer_init();
+	bench_run(&spawn_benches[0], 0, shrink ? "shrink" : "noshrink");
+	timer_done();
+}
+
+static int far_fd;
+static void __far *far_dst;
+static unsigned long far_bytes;
+static long far_got;
+
+BENCH(read_direct) {
+	while (iters--) {
+		lseek(far_fd, 0, SEEK_SET);
+		far_got = far_read(far_fd, far_dst, far_bytes);
+	}
+}
+
+BENCH(read_staged) {
+	while (iters--) {
+		lseek(far_fd, 0, SEEK_SET);
+		far_got = far_read_staged(far_fd, far_dst, far_bytes, ubuf1, sizeof ubuf1);
+	}
+}
+
+static const struct bench far_benches[] = {
+	BENCH_ENTRY(read_direct),
+	BENCH_ENTRY(read_staged),
+};
+
+/*
+ * Read a file into a DOS memory block over 64 KiB, straight into the block
+ * and through ubuf1. Repeated reads mostly come from the DOS buffers or a
+ * disk cache, which leaves the copying as the difference.
+ */
+static void far_bench(void) {
+	unsigned seg, i;
+	unsigned long med;
+
+	far_bytes = FARREAD_COPIES * (unsigned long)sizeof ubuf1;
+	dos_shrink();
+	seg = dos_alloc((far_bytes + 15) / 16);
+	if (!seg) {
+		printf("Far:   cannot allocate %lu bytes\n", far_bytes);
+		return;
+	}
+	far_dst = MK_FP(seg, 0);
+
+	far_fd = open(FARREAD_FILE, O_RDWR | O_CREAT | O_TRUNC, 0666);
+	if (far_fd < 0) {
+		printf("Far:   cannot create %s\n", FARREAD_FILE);
+		dos_free(seg);
+		return;
+	}
+	for (i = 0; i < FARREAD_COPIES; i++)
+		write(far_fd, ubuf1, sizeof ubuf1);
+
+	timer_init();
+	for (i = 0; i < BENCH_COUNT(far_benches); i++) {
+		med = bench_run(&far_benches[i], 0, "file");
+		printf("Far:   %s %lu of %lu bytes, %lu KiB/s\n", far_benches[i].name,
+		       far_got, far_bytes, med ? far_bytes * 10000UL / 1024 * 1000 / med : 0);
+	}
+	timer_done();
+
+	close(far_fd);
+	unlink(FARREAD_FILE);
+	dos_free(seg);
+}
+
+static int stream_in, stream_out;
+static unsigned stream_sum;
+static long stream_got;
+
+static void stream_rewind(void) {
+	lseek(stream_in, 0, SEEK_SET);
+	lseek(stream_out, 0, SEEK_SET);
+	stream_sum = 0;
+}
+
+BENCH(stream_single) {
+	while (iters--) {
+		stream_rewind();
+		stream_got = stream_copy(stream_in, stream_out, ubuf1, sizeof ubuf1, kern.sum, &stream_sum);
+	}
+}
+
+BENCH(stream_double) {
+	char *buf[2] = {ubuf1, ubuf2};
+	const unsigned size[2] = {sizeof ubuf1, UBUF2_BYTES};
+
+	while (iters--) {
+		stream_rewind();
+		stream_got = stream_copy2(stream_in, stream_out, buf, size, kern.sum, &stream_sum);
+	}
+}
+
+static const struct bench stream_benches[] = {
+	BENCH_ENTRY(stream_single),
+	BENCH_ENTRY(stream_double),
+};
+
+/* Create the input file and open both ends */
+static int stream_open(void) {
+	unsigned i;
+	int fd;
+
+	fd = open(STREAM_IN, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	for (i = 0; fd >= 0 && i < STREAM_COPIES; i++)
+		write(fd, ubuf1, sizeof ubuf1);
+	if (fd >= 0)
+		close(fd);
+	stream_in = open(STREAM_IN, O_RDONLY);
+	stream_out = open(STREAM_OUT, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0 || stream_in < 0 || stream_out < 0) {
+		printf("Stream: cannot create %s and %s\n", STREAM_IN, STREAM_OUT);
+		return -1;
+	}
+	return 0;
+}
+
+static void stream_close(void) {
+	close(stream_in);
+	close(stream_out);
+	unlink(STREAM_IN);
+	unlink(STREAM_OUT);
+}
+
+static void stream_report(const struct bench *b) {
+	unsigned long bytes = STREAM_COPIES * (unsigned long)sizeof ubuf1;
+	unsigned long med = bench_run(b, 0, "file");
+
+	printf("Stream: %s %ld of %lu bytes, sum=%5u, %lu KiB/s\n", b->name,
+	       stream_got, bytes, stream_sum, med ? bytes * 10000UL / 1024 * 1000 / med : 0);
+}
+
+/* Copy a file through ubuf1 alone, then ping-ponging between ubuf1 and ubuf2 */
+static void stream_bench(void) {
+	unsigned i;
+
+	if (stream_open() != 0)
+		return;
+	timer_init();
+	for (i = 0; i < BENCH_COUNT(stream_benches); i++)
+		stream_report(&stream_benches[i]);
+	timer_done();
+	stream_close();
+}
+
+static unsigned coro_pings;
+
+static void coro_ping(void *arg) {
+	unsigned n;
+
+	for (n = coro_pings; n; n--)
+		coro_yield();
+}
+
+/* Two coroutines passing back and forth: two switches an iteration */
+BENCH(coro_switch) {
+	coro_pings = iters;
+	coro_spawn(coro_ping, NULL, CORO_STACK);
+	coro_spawn(coro_ping, NULL, CORO_STACK);
+	coro_run();
+}
+
+/*
+ * The stream_copy2() pipeline as two coroutines: the producer reads into
+ * ubuf1 and ubuf2 in turn, the consumer sums and writes them. A slot is
+ * full from the read until the write; a length of 0 or -1 ends the stream.
+ */
+static char *const pipe_buf[2] = {ubuf1, ubuf2};
+static const unsigned pipe_size[2] = {sizeof ubuf1, UBUF2_BYTES};
+static int pipe_len[2];
+static char pipe_full[2];
+
+static void coro_produce(void *arg) {
+	int i = 0, n;
+
+	do {
+		while (pipe_full[i])
+			coro_yield();
+		n = coro_read(stream_in, pipe_buf[i], pipe_size[i]);
+		pipe_len[i] = n;
+		pipe_full[i] = 1;
+		i ^= 1;
+	} while (n > 0);
+}
+
+static void coro_consume(void *arg) {
+	int i = 0, n;
+
+	for (;;) {
+		while (!pipe_full[i])
+			coro_yield();
+		n = pipe_len[i];
+		if (n <= 0)
+			break;
+		stream_sum += kern.sum(pipe_buf[i], n);
+		if (stream_got >= 0 && coro_write(stream_out, pipe_buf[i], n) == n)
+			stream_got += n;
+		else
+			stream_got = -1;	/* keep draining, or the producer waits */
+		pipe_full[i] = 0;
+		i ^= 1;
+	}
+}
+
+BENCH(coro_pipe) {
+	while (iters--) {
+		stream_rewind();
+		stream_got = 0;
+		pipe_full[0] = pipe_full[1] = 0;
+		coro_spawn(coro_produce, NULL, CORO_STACK);
+		coro_spawn(coro_consume, NULL, CORO_STACK);
+		coro_run();
+	}
+}
+
+static const struct bench coro_switch_bench = BENCH_ENTRY(coro_switch);
+
+static const struct bench coro_benches[] = {
+	BENCH_ENTRY(stream_double),
+	BENCH_ENTRY(coro_pipe),
+};
+
+/* Context switch cost, then the coroutine pipeline against stream_copy2() */
+static void coro_bench(void) {
+	unsigned long med;
+	unsigned i;
+
+	timer_init();
+	med = bench_run(&coro_switch_bench, 0, "yield") / 2;
+	printf("Coro:  %lu.%lu us a switch\n", med / 10, med % 10);
+	if (stream_open() == 0) {
+		for (i = 0; i < BENCH_COUNT(coro_benches); i++)
+			stream_report(&coro_benches[i]);
+		stream_close();
+	}
+	timer_done();
+}
+
+int main(int argc, char **argv) {
+	int cpu = cpu_detect();
+	unsigned sum;
+
+	if (argc > 1 && strcmp(argv[1], "child") == 0)
+		return dos_block_size() / SPAWN_UNIT;
+
+	kernels_init(cpu);
+
 	printf("Sizes: ubuf1=%6u, ubuf2=%6u\n", sizeof ubuf1, sizeof ubuf2);
+	printf("CPU:   %s\n", cpu_name(cpu));
+
+	REGIONS_INIT();
+	TRACE_INIT(ubuf2 + UBUF2_BYTES, TRACE_BYTES);
+	REGION_BEGIN(R_FILL);
+	kern.fill(ubuf1, 0x5a, sizeof ubuf1);
+	REGION_END(R_FILL);
+	REGION_BEGIN(R_COPY);
+	kern.copy(ubuf2, ubuf1, UBUF2_BYTES);
+	REGION_END(R_COPY);
+	REGION_BEGIN(R_SUM);
+	sum = kern.sum(ubuf2, UBUF2_BYTES);
+	REGION_END(R_SUM);
+	printf("Sum:   ubuf2=%6u\n", sum);
+
+	if (argc > 1 && strcmp(argv[1], "bench") == 0)
+		bench(cpu);
+	if (argc > 1 && strcmp(argv[1], "prof") == 0)
+		profile(cpu);
+	if (argc > 1 && strcmp(argv[1], "uart") == 0)
+		uart_bench(argc > 2 ? atoi(argv[2]) : 1);
+	if (argc > 1 && strcmp(argv[1], "video") == 0)
+		video_bench();
+	if (argc > 1 && strcmp(argv[1], "spawn") == 0)
+		spawn_bench(argv[0], argc > 2 && strcmp(argv[2], "shrink") == 0);
+	if (argc > 1 && strcmp(argv[1], "farread") == 0)
+		far_bench();
+	if (argc > 1 && strcmp(argv[1], "stream") == 0)
+		stream_bench();
+	if (argc > 1 && strcmp(argv[1], "coro") == 0)
+		coro_bench();
+
+	REGIONS_DUMP("REGIONS.DAT");
+	TRACE_DUMP("TRACE.DAT");
 	return 0;
 }
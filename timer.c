@@ -0,0 +1,68 @@
+
+#include <conio.h>
+#include <i86.h>
+
+#include "timer.h"
+
+#define PIT_CH0		0x40
+#define PIT_CMD		0x43
+#define PIC_CMD		0x20
+
+static volatile unsigned long __far *const bios_ticks = MK_FP(0x0040, 0x006c);
+
+/*
+ * The BIOS runs channel 0 in mode 3, which counts down by two twice per
+ * period. Switch it to mode 2 with the same divisor so that the count falls
+ * linearly and can be combined with the BIOS tick count.
+ */
+void timer_init(void) {
+	_disable();
+	outp(PIT_CMD, 0x34);
+	outp(PIT_CH0, 0);
+	outp(PIT_CH0, 0);
+	_enable();
+}
+
+void timer_done(void) {
+	_disable();
+	outp(PIT_CMD, 0x36);
+	outp(PIT_CH0, 0);
+	outp(PIT_CH0, 0);
+	_enable();
+}
+
+/* timer_read() for callers that already run with interrupts disabled */
+unsigned long timer_read_locked(void) {
+	unsigned char lo, hi;
+	unsigned count;
+	unsigned long ticks;
+	int pending;
+
+	outp(PIT_CMD, 0x00);
+	lo = inp(PIT_CH0);
+	hi = inp(PIT_CH0);
+	ticks = *bios_ticks;
+	outp(PIC_CMD, 0x0a);
+	pending = inp(PIC_CMD) & 1;
+
+	count = -((hi << 8) | lo);
+	/* The counter wrapped but IRQ 0 has not been serviced yet */
+	if (pending && count < 0x8000)
+		ticks++;
+	return (ticks << 16) | count;
+}
+
+/* Time in PIT counts: BIOS ticks in the high word, elapsed count below. */
+unsigned long timer_read(void) {
+	unsigned long t;
+
+	_disable();
+	t = timer_read_locked();
+	_enable();
+	return t;
+}
+
+unsigned long timer_us(unsigned long counts) {
+	/* 1 / 1.193182 MHz is 0.8381 us; split to stay within 32 bits */
+	return (counts >> 10) * 858UL + ((counts & 0x3ff) * 838UL) / 1000;
+}
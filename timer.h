@@ -0,0 +1,13 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+/* PIT input clock; timer_read() counts at this rate */
+#define TIMER_HZ	1193182UL
+
+void timer_init(void);
+void timer_done(void);
+unsigned long timer_read(void);
+unsigned long timer_read_locked(void);
+unsigned long timer_us(unsigned long counts);
+
+#endif
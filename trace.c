@@ -0,0 +1,90 @@
+
+#include <stdio.h>
+#include <string.h>
+
+#include "dump.h"
+#include "trace.h"
+
+#ifdef EVENT_TRACE
+
+static struct trace_rec *ring;
+static unsigned mask, head;
+static unsigned long total;
+
+static const char *const names[TRACE_COUNT] = {
+#define TRACE_NAME(id, name)	name,
+	TRACE_LIST(TRACE_NAME)
+#undef TRACE_NAME
+};
+
+static inline unsigned irq_save(void) {
+	unsigned flags;
+
+	__asm__ volatile ("pushf\n\tcli\n\tpopw %0" : "=r" (flags) : : "memory");
+	return flags;
+}
+
+static inline void irq_restore(unsigned flags) {
+	__asm__ volatile ("pushw %0\n\tpopf" : : "r" (flags) : "memory", "cc");
+}
+
+/* Use the largest power of two number of records that fits; none disables */
+void trace_init(void *buf, unsigned size) {
+	unsigned n = 1;
+
+	while (n * 2 <= size / sizeof *ring)
+		n *= 2;
+	ring = size < sizeof *ring ? NULL : buf;
+	mask = n - 1;
+	head = 0;
+	total = 0;
+}
+
+/*
+ * Interrupts are masked only while the slot is claimed and the timestamp
+ * taken, so records are in time order; the slot is filled in afterwards.
+ * A handler logging in between gets the next slot.
+ */
+void trace_log(unsigned event, unsigned arg) {
+	struct trace_rec *r;
+	unsigned long t;
+	unsigned flags = irq_save();
+
+	if (!ring) {
+		irq_restore(flags);
+		return;
+	}
+	r = &ring[head];
+	head = (head + 1) & mask;
+	total++;
+	t = timer_read_locked();
+	irq_restore(flags);
+
+	r->time = t;
+	r->event = event;
+	r->arg = arg;
+}
+
+int trace_dump(const char *path) {
+	FILE *f = fopen(path, "wb");
+	unsigned i;
+	int err = 0;
+
+	if (!f)
+		return -1;
+	err |= fputs(TRACE_MAGIC, f) == EOF;
+	err |= dump_put(f, ring ? mask + 1 : 0, 2);
+	err |= dump_put(f, head, 2);
+	err |= dump_put(f, total, 4);
+	err |= dump_put(f, TRACE_COUNT, 2);
+	for (i = 0; i < TRACE_COUNT; i++) {
+		err |= dump_put(f, strlen(names[i]), 1);
+		err |= fputs(names[i], f) == EOF;
+	}
+	if (ring)
+		err |= fwrite(ring, sizeof *ring, mask + 1, f) != mask + 1;
+	err |= fclose(f) != 0;
+	return err ? -1 : 0;
+}
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+/*
+ * Event trace: TRACE(id, arg) appends a timestamped 8-byte record to a ring
+ * buffer, overwriting the oldest records once it is full. It may be called
+ * from interrupt handlers. Only builds with EVENT_TRACE defined log
+ * anything; otherwise the macros expand to nothing.
+ *
+ * TRACE_INIT() sets the timer to mode 2 for the timestamps and TRACE_DUMP()
+ * writes the ring for tracedump.py, then restores the timer.
+ */
+
+/* Events: id, name in the dump. A name starting with '/' ends the span
+   opened by the event of the same name. */
+#define TRACE_LIST(E) \
+	E(T_LEVEL, "level") \
+	E(T_FILL, "fill") \
+	E(T_FILL_END, "/fill") \
+	E(T_COPY, "copy") \
+	E(T_COPY_END, "/copy")
+
+enum trace_id {
+#define TRACE_ENUM(id, name)	id,
+	TRACE_LIST(TRACE_ENUM)
+#undef TRACE_ENUM
+	TRACE_COUNT
+};
+
+#ifdef EVENT_TRACE
+
+#include "timer.h"
+
+/* Dump: "TRC1", slots, next slot (words), records logged (dword), event
+   count (word) and per event name length (byte) and name, then the slots */
+#define TRACE_MAGIC	"TRC1"
+
+struct trace_rec {
+	unsigned long time;	/* timer_read() format */
+	unsigned event;
+	unsigned arg;
+};
+
+void trace_init(void *buf, unsigned size);
+void trace_log(unsigned event, unsigned arg);
+int trace_dump(const char *path);
+
+#define TRACE(id, arg)		trace_log(id, arg)
+#define TRACE_INIT(buf, size)	(trace_init(buf, size), timer_init())
+#define TRACE_DUMP(path)	(trace_dump(path), timer_done())
+
+#else
+
+#define TRACE(id, arg)		((void)0)
+#define TRACE_INIT(buf, size)	((void)0)
+#define TRACE_DUMP(path)	((void)0)
+
+#endif
+
+#endif
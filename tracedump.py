@@ -0,0 +1,81 @@
+#!/usr/bin/python3
+
+import argparse
+import struct
+from pathlib import Path
+from sys import exit
+
+
+MAGIC = b'TRC1'
+TIMER_HZ = 1193182.0
+
+
+def read(path):
+    """Event names and the logged (time, event, arg) records, oldest first."""
+    data = Path(path).read_bytes()
+    if data[:4] != MAGIC:
+        print("%s: not a trace dump" % path)
+        exit(1)
+    slots, head, total, nevents = struct.unpack_from('<HHLH', data, 4)
+    pos = 14
+    names = []
+    for _ in range(nevents):
+        n = data[pos]
+        names.append(data[pos + 1:pos + 1 + n].decode('ascii', 'replace'))
+        pos += 1 + n
+    ring = [struct.unpack_from('<LHH', data, pos + 8 * i) for i in range(slots)]
+    if total <= slots:
+        return names, ring[:total], 0
+    return names, ring[head:] + ring[:head], total - slots
+
+
+def unwrap(records):
+    """Timestamps in PIT counts from the first record; the tick count in
+    the high word is only 16 bits wide, so it wraps about hourly."""
+    out = []
+    base = prev = None
+    extra = 0
+    for t, event, arg in records:
+        if prev is not None and t < prev and prev - t > 0x80000000:
+            extra += 1 << 32
+        prev = t
+        t += extra
+        if base is None:
+            base = t
+        out.append((t - base, event, arg))
+    return out
+
+
+def us(counts):
+    return counts * 1e6 / TIMER_HZ
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Timeline of an event trace dump (TRACE.DAT).")
+    parser.add_argument('dump', nargs='?', default='TRACE.DAT')
+    parser.add_argument('-e', '--event', action='append', help="only show these events (and their ends)")
+    args = parser.parse_args()
+
+    names, records, lost = read(args.dump)
+    if lost:
+        print("%u older records overwritten" % lost)
+
+    def name(e):
+        return names[e] if e < len(names) else 'event%u' % e
+
+    print("%12s %10s  %-10s %6s  %s" % ("time us", "delta us", "event", "arg", "span us"))
+    open_spans = {}
+    prev = None
+    for t, event, arg in unwrap(records):
+        n = name(event)
+        span = ''
+        if n.startswith('/'):
+            start = open_spans.pop(n[1:], None)
+            if start is not None:
+                span = '%.1f' % us(t - start)
+        else:
+            open_spans[n] = t
+        if not args.event or n.lstrip('/') in args.event:
+            print(("%12.1f %10s  %-10s %6u  %s" % (us(t), '%.1f' % us(t - prev) if prev is not None else '',
+                                                 n, arg, span)).rstrip())
+        prev = t
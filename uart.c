@@ -0,0 +1,271 @@
+
+#include <conio.h>
+#include <i86.h>
+
+#include "uart.h"
+
+#define PIC_MASK	0x21
+
+/* Register offsets from the port base */
+#define UART_RBR	0	/* THR on write; DLL with DLAB */
+#define UART_IER	1	/* DLM with DLAB */
+#define UART_IIR	2	/* FCR on write */
+#define UART_LCR	3
+#define UART_MCR	4
+#define UART_LSR	5
+
+#define IER_RX		0x01
+#define IER_TX		0x02
+#define IER_LINE	0x04
+
+/* Shared with the handler, which addresses them by name */
+volatile unsigned uart_base;
+volatile unsigned uart_rxbuf, uart_rxmask, uart_rxhead, uart_rxtail;
+volatile unsigned uart_txbuf, uart_txmask, uart_txhead, uart_txtail;
+volatile unsigned uart_fifo, uart_ints, uart_maxburst, uart_overrun, uart_rxdrop;
+
+static int uart_irq = -1;
+static unsigned char old_mask;
+static void __far *__far *const ivt = MK_FP(0, 0);
+
+struct isr_data {
+	void __far *old;
+	unsigned ds;
+};
+
+/*
+ * The handler lives inside this function, as in prof.c. It services the
+ * UART until IIR reports nothing pending:
+ *   received data or timeout: drain while LSR reports data ready, noting
+ *     the largest number of bytes drained at once;
+ *   transmitter empty: move up to uart_fifo bytes from the tx ring, or
+ *     turn the transmit interrupt off once the ring is empty;
+ *   line status: count overruns; modem status: read MSR to clear it.
+ */
+static __attribute__((noinline)) struct isr_data __far *isr_data(void) {
+	unsigned ofs, seg;
+
+	__asm__ volatile ("jmp 99f\n"
+			  "uart_old:\n\t"
+			  ".long 0\n"
+			  "uart_ds:\n\t"
+			  ".word 0\n"
+			  "uart_isr:\n\t"
+			  "pushw %%ax\n\t"
+			  "pushw %%bx\n\t"
+			  "pushw %%cx\n\t"
+			  "pushw %%dx\n\t"
+			  "pushw %%ds\n\t"
+			  "movw %%cs:uart_ds, %%ds\n\t"
+			  "incw uart_ints\n"
+			  "1:\n\t"
+			  "movw uart_base, %%dx\n\t"
+			  "addw $2, %%dx\n\t"		/* IIR */
+			  "inb %%dx, %%al\n\t"
+			  "testb $1, %%al\n\t"
+			  "jnz 9f\n\t"
+			  "andb $6, %%al\n\t"
+			  "cmpb $4, %%al\n\t"
+			  "je 2f\n\t"
+			  "cmpb $2, %%al\n\t"
+			  "je 5f\n\t"
+			  "cmpb $6, %%al\n\t"
+			  "je 8f\n\t"
+			  "addw $4, %%dx\n\t"		/* MSR */
+			  "inb %%dx, %%al\n\t"
+			  "jmp 1b\n"
+			  "8:\n\t"
+			  "addw $3, %%dx\n\t"		/* LSR */
+			  "inb %%dx, %%al\n\t"
+			  "testb $2, %%al\n\t"
+			  "jz 1b\n\t"
+			  "incw uart_overrun\n\t"
+			  "jmp 1b\n"
+			  "2:\n\t"
+			  "xorw %%cx, %%cx\n"
+			  "3:\n\t"
+			  "movw uart_base, %%dx\n\t"
+			  "addw $5, %%dx\n\t"		/* LSR */
+			  "inb %%dx, %%al\n\t"
+			  "testb $2, %%al\n\t"
+			  "jz 31f\n\t"
+			  "incw uart_overrun\n"
+			  "31:\n\t"
+			  "testb $1, %%al\n\t"
+			  "jz 4f\n\t"
+			  "subw $5, %%dx\n\t"		/* RBR */
+			  "inb %%dx, %%al\n\t"
+			  "incw %%cx\n\t"
+			  "movw uart_rxhead, %%bx\n\t"
+			  "incw %%bx\n\t"
+			  "andw uart_rxmask, %%bx\n\t"
+			  "cmpw uart_rxtail, %%bx\n\t"
+			  "je 32f\n\t"
+			  "pushw %%bx\n\t"
+			  "movw uart_rxhead, %%bx\n\t"
+			  "addw uart_rxbuf, %%bx\n\t"
+			  "movb %%al, (%%bx)\n\t"
+			  "popw %%bx\n\t"
+			  "movw %%bx, uart_rxhead\n\t"
+			  "jmp 3b\n"
+			  "32:\n\t"
+			  "incw uart_rxdrop\n\t"
+			  "jmp 3b\n"
+			  "4:\n\t"
+			  "cmpw uart_maxburst, %%cx\n\t"
+			  "jbe 1b\n\t"
+			  "movw %%cx, uart_maxburst\n\t"
+			  "jmp 1b\n"
+			  "5:\n\t"
+			  "movw uart_fifo, %%cx\n\t"
+			  "movw uart_base, %%dx\n"	/* THR */
+			  "6:\n\t"
+			  "movw uart_txtail, %%bx\n\t"
+			  "cmpw uart_txhead, %%bx\n\t"
+			  "je 7f\n\t"
+			  "pushw %%bx\n\t"
+			  "addw uart_txbuf, %%bx\n\t"
+			  "movb (%%bx), %%al\n\t"
+			  "popw %%bx\n\t"
+			  "outb %%al, %%dx\n\t"
+			  "incw %%bx\n\t"
+			  "andw uart_txmask, %%bx\n\t"
+			  "movw %%bx, uart_txtail\n\t"
+			  "loop 6b\n\t"
+			  "jmp 1b\n"
+			  "7:\n\t"
+			  "incw %%dx\n\t"		/* IER: receive and line status only */
+			  "movb $0x05, %%al\n\t"
+			  "outb %%al, %%dx\n\t"
+			  "jmp 1b\n"
+			  "9:\n\t"
+			  "movb $0x20, %%al\n\t"
+			  "outb %%al, $0x20\n\t"
+			  "popw %%ds\n\t"
+			  "popw %%dx\n\t"
+			  "popw %%cx\n\t"
+			  "popw %%bx\n\t"
+			  "popw %%ax\n\t"
+			  "iret\n"
+			  "99:\n\t"
+			  "movw $uart_old, %0\n\t"
+			  "movw %%cs, %1"
+			  : "=r" (ofs), "=r" (seg));
+	return MK_FP(seg, ofs);
+}
+
+static unsigned ring_mask(unsigned size) {
+	unsigned n = 1;
+
+	while (n * 2 <= size)
+		n *= 2;
+	return n - 1;
+}
+
+int uart_open(unsigned base, int irq, unsigned long baud,
+	      char *rx, unsigned rx_size, char *tx, unsigned tx_size) {
+	struct isr_data __far *d = isr_data();
+	unsigned div;
+	unsigned ds;
+
+	/* The divisor latch holds 1 to 0xffff */
+	if (!baud || baud > UART_CLOCK || UART_CLOCK / baud > 0xffff)
+		return -1;
+	div = UART_CLOCK / baud;
+	if (irq < 2 || irq > 7 || uart_irq >= 0)
+		return -1;
+	/* Nothing answers at this base */
+	if (inp(base + UART_IIR) == 0xff)
+		return -1;
+
+	__asm__ ("movw %%ds, %0" : "=r" (ds));
+	uart_base = base;
+	uart_rxbuf = (unsigned)rx;
+	uart_rxmask = ring_mask(rx_size);
+	uart_txbuf = (unsigned)tx;
+	uart_txmask = ring_mask(tx_size);
+	uart_rxhead = uart_rxtail = uart_txhead = uart_txtail = 0;
+	uart_ints = uart_maxburst = uart_overrun = uart_rxdrop = 0;
+
+	outp(base + UART_IER, 0);
+	outp(base + UART_LCR, 0x80);
+	outp(base + UART_RBR, div & 0xff);
+	outp(base + UART_IER, div >> 8);
+	outp(base + UART_LCR, 0x03);		/* 8N1 */
+
+	/* FIFOs on, both cleared, receive trigger at 8 bytes */
+	outp(base + UART_IIR, 0x87);
+	uart_fifo = (inp(base + UART_IIR) & 0xc0) == 0xc0 ? 16 : 1;
+	if (uart_fifo == 1)
+		outp(base + UART_IIR, 0);
+
+	while (inp(base + UART_LSR) & 1)
+		inp(base + UART_RBR);
+
+	_disable();
+	d->old = ivt[8 + irq];
+	d->ds = ds;
+	ivt[8 + irq] = d + 1;
+	old_mask = inp(PIC_MASK);
+	outp(PIC_MASK, old_mask & ~(1 << irq));
+	outp(base + UART_MCR, 0x0b);		/* DTR, RTS, OUT2 gates the IRQ */
+	outp(base + UART_IER, IER_RX | IER_LINE);
+	_enable();
+
+	uart_irq = irq;
+	return 0;
+}
+
+void uart_close(void) {
+	struct isr_data __far *d = isr_data();
+
+	if (uart_irq < 0)
+		return;
+	_disable();
+	outp(uart_base + UART_IER, 0);
+	outp(uart_base + UART_MCR, 0x03);
+	outp(PIC_MASK, (inp(PIC_MASK) & ~(1 << uart_irq)) | (old_mask & (1 << uart_irq)));
+	ivt[8 + uart_irq] = d->old;
+	_enable();
+	uart_irq = -1;
+}
+
+unsigned uart_read(char *buf, unsigned n) {
+	const char *ring = (const char *)uart_rxbuf;
+	unsigned tail = uart_rxtail, head = uart_rxhead, i = 0;
+
+	while (i < n && tail != head) {
+		buf[i++] = ring[tail];
+		tail = (tail + 1) & uart_rxmask;
+	}
+	__asm__ volatile ("" : : : "memory");
+	uart_rxtail = tail;
+	return i;
+}
+
+/* Queue as much as fits; enabling the transmit interrupt starts the
+   handler if the transmitter is idle */
+unsigned uart_write(const char *buf, unsigned n) {
+	char *ring = (char *)uart_txbuf;
+	unsigned head = uart_txhead, i = 0;
+
+	while (i < n && ((head + 1) & uart_txmask) != uart_txtail) {
+		ring[head] = buf[i++];
+		head = (head + 1) & uart_txmask;
+	}
+	__asm__ volatile ("" : : : "memory");
+	uart_txhead = head;
+	if (i)
+		outp(uart_base + UART_IER, IER_RX | IER_TX | IER_LINE);
+	return i;
+}
+
+void uart_stats(struct uart_stats *s) {
+	_disable();
+	s->fifo = uart_fifo;
+	s->ints = uart_ints;
+	s->max_burst = uart_maxburst;
+	s->overrun = uart_overrun;
+	s->dropped = uart_rxdrop;
+	_enable();
+}
@@ -0,0 +1,38 @@
+#ifndef UART_H
+#define UART_H
+
+/*
+ * Interrupt-driven 8250/16450/16550A driver for one port on the master
+ * PIC (IRQ 2 to 7). Received and transmitted bytes go through single
+ * producer, single consumer rings: the handler only advances the rx head
+ * and the tx tail, the program only the rx tail and the tx head. Each
+ * ring uses the largest power of two that fits its buffer.
+ *
+ * On a 16550A the FIFOs are enabled with the receive trigger at
+ * UART_TRIGGER bytes, and the handler refills up to 16 bytes per transmit
+ * interrupt.
+ */
+#define COM1_BASE	0x3f8
+#define COM1_IRQ	4
+#define COM2_BASE	0x2f8
+#define COM2_IRQ	3
+
+#define UART_CLOCK	115200UL
+#define UART_TRIGGER	8
+
+struct uart_stats {
+	unsigned fifo;		/* transmit burst: 16 with FIFOs, else 1 */
+	unsigned ints;		/* handler entries */
+	unsigned max_burst;	/* most bytes drained in one service */
+	unsigned overrun;	/* bytes the UART lost (LSR OE) */
+	unsigned dropped;	/* bytes lost to a full rx ring */
+};
+
+int uart_open(unsigned base, int irq, unsigned long baud,
+	      char *rx, unsigned rx_size, char *tx, unsigned tx_size);
+void uart_close(void);
+unsigned uart_read(char *buf, unsigned n);
+unsigned uart_write(const char *buf, unsigned n);
+void uart_stats(struct uart_stats *s);
+
+#endif
@@ -0,0 +1,90 @@
+#!/usr/bin/python3
+
+"""Host end of 'test uart': echo everything the emulated UART sends.
+
+Point the emulator's COM port at a pty (QEMU -serial /dev/pts/N, 86Box
+host serial passthrough) or at a TCP socket (QEMU -serial tcp:..., DOSBox-X
+serial1=nullmodem), and this echoes the bytes back, reporting the rate.
+"""
+
+import argparse
+import os
+import select
+import socket
+import termios
+import time
+import tty
+
+
+def open_pty():
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    attrs = termios.tcgetattr(slave)
+    attrs[3] &= ~termios.ECHO
+    termios.tcsetattr(slave, termios.TCSANOW, attrs)
+    print("pty %s" % os.ttyname(slave))
+    return master, slave
+
+
+def open_socket(args):
+    if args.listen:
+        srv = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        srv.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        srv.bind(('127.0.0.1', args.listen))
+        srv.listen(1)
+        print("listening on 127.0.0.1:%u" % args.listen)
+        s, peer = srv.accept()
+        srv.close()
+        print("connected from %s:%u" % peer)
+    else:
+        host, _, port = args.connect.rpartition(':')
+        s = socket.create_connection((host or '127.0.0.1', int(port)))
+    s.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    return s.fileno(), s
+
+
+def pump(fd, echo, interval):
+    total = window = 0
+    start = last = time.time()
+    try:
+        while True:
+            r, _, _ = select.select([fd], [], [], interval)
+            if r:
+                try:
+                    data = os.read(fd, 4096)
+                except OSError:
+                    data = b''      # pty closed by the emulator
+                if not data:
+                    break
+                if echo:
+                    view = memoryview(data)
+                    while view:
+                        view = view[os.write(fd, view):]
+                total += len(data)
+                window += len(data)
+            now = time.time()
+            if now - last >= interval:
+                if window:
+                    print("%8u bytes/s, %u total" % (window / (now - last), total))
+                window = 0
+                last = now
+    except KeyboardInterrupt:
+        pass
+    print("%u bytes in %.1f s" % (total, time.time() - start))
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Echo pump for the UART benchmark ('test uart').")
+    where = parser.add_mutually_exclusive_group(required=True)
+    where.add_argument('--pty', action='store_true', help="create a pty and print its name")
+    where.add_argument('--listen', type=int, metavar='PORT', help="wait for the emulator to connect")
+    where.add_argument('--connect', metavar='[HOST:]PORT', help="connect to the emulator's serial server")
+    parser.add_argument('--sink', action='store_true', help="count bytes without echoing them")
+    parser.add_argument('--interval', type=float, default=1.0, help="seconds between rate reports")
+    args = parser.parse_args()
+
+    if args.pty:
+        fd, keep = open_pty()
+    else:
+        fd, keep = open_socket(args)
+    pump(fd, not args.sink, args.interval)
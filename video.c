@@ -0,0 +1,89 @@
+
+#include <conio.h>
+#include <i86.h>
+
+#include "video.h"
+
+static unsigned char __far *const bda = MK_FP(0x0040, 0);
+
+static unsigned video_seg, cols, rows, crtc;
+
+void video_init(void) {
+	video_seg = bda[0x49] == 7 ? 0xb000 : 0xb800;
+	cols = *(unsigned __far *)(bda + 0x4a);
+	/* Rows less one on the EGA and later; 0 before that */
+	rows = bda[0x84] ? bda[0x84] + 1 : 25;
+	crtc = *(unsigned __far *)(bda + 0x63);
+}
+
+/* Move rows 1.. up by one and blank the last */
+static void scroll(void) {
+	unsigned src = cols * 2, dst = 0, n = (rows - 1) * cols;
+
+	__asm__ volatile ("pushw %%ds\n\t"
+			  "pushw %%es\n\t"
+			  "movw %3, %%ds\n\t"
+			  "movw %3, %%es\n\t"
+			  "cld\n\t"
+			  "rep movsw\n\t"
+			  "movw %4, %%cx\n\t"
+			  "rep stosw\n\t"
+			  "popw %%es\n\t"
+			  "popw %%ds"
+			  : "+S" (src), "+D" (dst), "+c" (n)
+			  : "b" (video_seg), "d" (cols), "a" ((VIDEO_ATTR << 8) | ' ')
+			  : "memory");
+}
+
+static void set_cursor(unsigned x, unsigned y) {
+	unsigned pos = y * cols + x;
+
+	bda[0x50] = x;
+	bda[0x51] = y;
+	outp(crtc, 0x0e);
+	outp(crtc + 1, pos >> 8);
+	outp(crtc, 0x0f);
+	outp(crtc + 1, pos & 0xff);
+}
+
+void video_write(const char *s, unsigned n) {
+	unsigned x = bda[0x50], y = bda[0x51];
+	unsigned __far *row = MK_FP(video_seg, y * cols * 2);
+
+	while (n--) {
+		unsigned char c = *s++;
+
+		switch (c) {
+		case '\r':
+			x = 0;
+			break;
+		case '\n':
+			y++;
+			row += cols;
+			break;
+		case '\b':
+			if (x)
+				x--;
+			break;
+		case '\t':
+			x = (x + 8) & ~7;
+			break;
+		case '\a':
+			break;
+		default:
+			row[x++] = (VIDEO_ATTR << 8) | c;
+			break;
+		}
+		if (x >= cols) {
+			x = 0;
+			y++;
+			row += cols;
+		}
+		if (y >= rows) {
+			scroll();
+			y = rows - 1;
+			row -= cols;
+		}
+	}
+	set_cursor(x, y);
+}
@@ -0,0 +1,15 @@
+#ifndef VIDEO_H
+#define VIDEO_H
+
+/*
+ * Console output written straight into text-mode video memory (B800h, or
+ * B000h in mode 7), page 0. The cursor is taken from and given back to the
+ * BIOS data area on every call, so output through DOS can be mixed in.
+ * Handles CR, LF, BS and TAB, and scrolls with REP MOVSW.
+ */
+#define VIDEO_ATTR	0x07
+
+void video_init(void);
+void video_write(const char *s, unsigned n);
+
+#endif
@@ -0,0 +1,235 @@
+#!/usr/bin/python3
+
+import argparse
+from pathlib import Path
+
+import dis86
+from program import Program
+
+
+class Node:
+    """A basic block, or a collapsed loop standing in for its body."""
+
+    def __init__(self, addr, end):
+        self.addr = addr
+        self.end = end
+        self.succs = set()
+        self.best = 0
+        self.worst = 0
+
+
+class Annotations:
+    """Loop and REP bounds ('func N', 'func+0xoff N') and call targets ('func -> a b')."""
+
+    def __init__(self, path=None):
+        self.bounds = {}
+        self.calls = {}
+        if path:
+            self._read(path)
+
+    def _read(self, path):
+        for line in Path(path).read_text().splitlines():
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            if '->' in line:
+                func, callees = line.split('->', 1)
+                self.calls.setdefault(func.strip(), []).extend(callees.split())
+                continue
+            where, bound = line.split()
+            if '+' in where:
+                func, off = where.split('+', 1)
+                self.bounds[(func, int(off, 0))] = int(bound, 0)
+            else:
+                self.bounds[(where, None)] = int(bound, 0)
+
+    def bound(self, func, off):
+        if (func, off) in self.bounds:
+            return self.bounds[(func, off)]
+        return self.bounds.get((func, None))
+
+
+class Estimator:
+    def __init__(self, prog, ann, cpu, default_bound):
+        self.prog = prog
+        self.ann = ann
+        self.cpu = cpu
+        self.default_bound = default_bound
+        self.memo = {}
+        self.active = set()
+        self.notes = {}
+
+    def note(self, func, text):
+        self.notes.setdefault(func, [])
+        if text not in self.notes[func]:
+            self.notes[func].append(text)
+
+    def bound(self, sym, addr):
+        b = self.ann.bound(sym.name, addr - sym.addr)
+        if b is None:
+            self.note(sym.name, "no bound at +0x%x" % (addr - sym.addr))
+            return self.default_bound
+        return b
+
+    def call_cost(self, sym, insn):
+        if insn.kind == dis86.K_CALL:
+            callee = self.prog.target(sym, insn.target)
+            names = [callee.name] if callee else []
+        else:
+            callee = self.prog.far_target(insn)
+            names = [callee.name] if callee else self.ann.calls.get(sym.name, [])
+        if not names:
+            self.note(sym.name, "unresolved %s at +0x%x" % (insn.kind, insn.addr - sym.addr))
+            return 0, 0
+        costs = [self.function(self.prog.function(n) or n) for n in names]
+        costs = [c for c in costs if c is not None]
+        if not costs:
+            return 0, 0
+        return min(c[0] for c in costs), max(c[1] for c in costs)
+
+    def insn_cost(self, sym, insn):
+        lo, hi = insn.cycles[self.cpu]
+        if lo is None:
+            self.note(sym.name, "%s not timed on the %s" % (insn.mnem, self.cpu))
+            lo = hi = 0
+        if insn.rep:
+            n = self.bound(sym, insn.addr)
+            per = insn.rep[self.cpu] or 0
+            lo, hi = lo, hi + per * n
+        if insn.kind in (dis86.K_CALL, dis86.K_CALLI, dis86.K_CALLF):
+            c = self.call_cost(sym, insn)
+            lo, hi = lo + c[0], hi + c[1]
+        elif insn.kind == dis86.K_INT:
+            self.note(sym.name, "int %s not included" % insn.ops[0] if insn.ops else "int3")
+        elif insn.kind == dis86.K_JMPI:
+            self.note(sym.name, "indirect jump at +0x%x" % (insn.addr - sym.addr))
+        return lo, hi
+
+    def blocks(self, sym, insns):
+        leaders = {sym.addr}
+        for i in insns:
+            if i.kind in dis86.ENDS_BLOCK:
+                leaders.add(i.end)
+                if i.target is not None and sym.addr <= i.target < sym.end:
+                    leaders.add(i.target)
+        leaders = sorted(a for a in leaders if sym.addr <= a < sym.end)
+
+        nodes = {}
+        cur = None
+        for i in insns:
+            if i.addr in leaders or cur is None:
+                cur = Node(i.addr, i.end)
+                nodes[i.addr] = cur
+            cur.end = i.end
+            lo, hi = self.insn_cost(sym, i)
+            cur.best += lo
+            cur.worst += hi
+            if i.kind in dis86.ENDS_BLOCK:
+                if i.target is not None:
+                    if sym.addr <= i.target < sym.end:
+                        cur.succs.add(i.target)
+                    else:
+                        # Tail call: charge the target function
+                        callee = self.prog.target(sym, i.target)
+                        c = self.function(callee) if callee else None
+                        if c:
+                            cur.best += c[0]
+                            cur.worst += c[1]
+                if i.kind not in dis86.NO_FALLTHROUGH and i.end < sym.end:
+                    cur.succs.add(i.end)
+            elif i.end in leaders:
+                cur.succs.add(i.end)
+        return nodes
+
+    def collapse_loops(self, sym, nodes):
+        while True:
+            back = [(u.end - v, u, v) for u in nodes.values() for v in u.succs if v <= u.addr]
+            if not back:
+                return
+            span, latch, head = min(back, key=lambda b: b[0])
+            end = max(n.end for n in nodes.values() if head <= n.addr < latch.end)
+            body = dict((a, n) for a, n in nodes.items() if head <= a < end)
+            latches = [n for n in body.values() if head in n.succs]
+
+            # Worst case: N passes over the longest header-to-latch path
+            inner = dict((a, set(s for s in n.succs if s in body and s != head)) for a, n in body.items())
+            longest = self.path(body, inner, head, max, 'worst')
+            per_pass = max(longest.get(n.addr, 0) for n in latches)
+            exits = [n for n in body.values() if any(s not in body for s in n.succs)]
+            shortest = self.path(body, inner, head, min, 'best')
+            best = min((shortest[n.addr] for n in exits if n.addr in shortest), default=shortest.get(head, 0))
+
+            loop = Node(head, end)
+            loop.worst = per_pass * self.bound(sym, head)
+            loop.best = best
+            loop.succs = set(s for n in body.values() for s in n.succs if s not in body)
+            for a in body:
+                del nodes[a]
+            for n in nodes.values():
+                if any(s in body for s in n.succs):
+                    n.succs = set(s for s in n.succs if s not in body) | {head}
+            nodes[head] = loop
+
+    @staticmethod
+    def path(nodes, succs, start, pick, attr):
+        """Extreme path cost from start to every node of a DAG, inclusive."""
+        order = sorted(nodes)
+        dist = {start: getattr(nodes[start], attr)}
+        for a in order:
+            if a not in dist:
+                continue
+            for s in succs[a]:
+                d = dist[a] + getattr(nodes[s], attr)
+                dist[s] = d if s not in dist else pick(dist[s], d)
+        return dist
+
+    def function(self, sym):
+        """(best, worst) cycles of one call, or None for code outside the map."""
+        if isinstance(sym, str):
+            self.note(sym, "not in the map")
+            return None
+        if sym.name in self.memo:
+            return self.memo[sym.name]
+        if sym.name in self.active:
+            self.note(sym.name, "recursive")
+            return 0, 0
+        self.active.add(sym.name)
+        nodes = self.blocks(sym, self.prog.insns(sym))
+        self.collapse_loops(sym, nodes)
+        succs = dict((a, set(s for s in n.succs if s in nodes)) for a, n in nodes.items())
+        worst = self.path(nodes, succs, sym.addr, max, 'worst')
+        best = self.path(nodes, succs, sym.addr, min, 'best')
+        exits = [a for a, n in nodes.items() if not succs[a]]
+        result = (min((best[a] for a in exits if a in best), default=0),
+                  max((worst[a] for a in exits if a in worst), default=0))
+        self.active.discard(sym.name)
+        self.memo[sym.name] = result
+        return result
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Static best/worst-case cycle estimates per function.")
+    parser.add_argument('exe', nargs='?', default='test-std.exe')
+    parser.add_argument('map', nargs='?', default='test-std.map')
+    parser.add_argument('-f', '--function', action='append', help="only report these functions")
+    parser.add_argument('--ann', help="loop bounds and indirect call targets")
+    parser.add_argument('--bound', type=int, default=1, metavar='N',
+                        help="iterations assumed for loops and REP prefixes without a bound (default 1)")
+    args = parser.parse_args()
+
+    prog = Program(args.exe, args.map)
+    ann = Annotations(args.ann)
+    est = dict((c, Estimator(prog, ann, c, args.bound)) for c in dis86.CPUS)
+
+    funcs = [prog.function(f) for f in args.function] if args.function else prog.functions()
+    print("%-24s %6s  %23s  %23s" % ("function", "bytes", "8088 best..worst", "286 best..worst"))
+    for f in funcs:
+        if f is None:
+            continue
+        r = dict((c, est[c].function(f)) for c in dis86.CPUS)
+        print("%-24s %6u  %23s  %23s" % (f.name, f.size,
+              "%u..%u" % r['8088'], "%u..%u" % r['286']))
+        notes = est['8088'].notes.get(f.name, [])
+        notes += [n for n in est['286'].notes.get(f.name, []) if n not in notes]
+        for n in notes:
+            print("%-24s   * %s" % ('', n))